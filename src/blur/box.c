@@ -25,6 +25,8 @@ void box_setup_callbacks(composite_blur_filter_data_t *data)
 
 void render_video_box(composite_blur_filter_data_t *data)
 {
+	set_dither_strength(&data->param_dither_strength,
+			    get_pipeline_format());
 	switch (data->blur_type) {
 	case TYPE_AREA:
 		box_area_blur(data);
@@ -74,7 +76,12 @@ static float get_box_blur_radius(composite_blur_filter_data_t *data)
 		if (data_to &&
 		    data_to->blur_algorithm == data->blur_algorithm &&
 		    data_to->blur_type == data->blur_type) {
-			radius = radius * (1.0f - f) + data_to->radius * f;
+			// data_to may run at a different processing scale.
+			const float radius_to =
+				data_to->radius *
+				(float)data_to->processing_scale /
+				(float)data->processing_scale;
+			radius = radius * (1.0f - f) + radius_to * f;
 		} else if (f > 0.5f) {
 			radius *= 1.0f - (f - 0.5f) * 2.0f;
 		} else {
@@ -110,67 +117,80 @@ static void box_area_blur(composite_blur_filter_data_t *data)
 	}
 
 	texture = blend_composite(texture, data);
-	const int passes = data->passes < 1 ? 1 : data->passes;
-	for (int i = 0; i < passes; i++) {
-		// 1. First pass- apply 1D blur kernel to horizontal dir.
-		data->render2 = create_or_reset_texrender(data->render2);
-
-		gs_eparam_t *image =
-			gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
-
-		if (data->param_radius) {
-			gs_effect_set_float(data->param_radius, radius);
-		}
+	data->output_texrender =
+		create_or_reset_texrender(data->output_texrender);
 
-		struct vec2 texel_step;
-		texel_step.x = 1.0f / data->width;
-		texel_step.y = 0.0f;
-		if (data->param_texel_step) {
-			gs_effect_set_vec2(data->param_texel_step, &texel_step);
-		}
-
-		set_blending_parameters();
-
-		if (gs_texrender_begin(data->render2, data->width,
-				       data->height)) {
-			gs_ortho(0.0f, (float)data->width, 0.0f,
-				 (float)data->height, -100.0f, 100.0f);
-			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->render2);
-		}
-
-		// 2. Save texture from first pass in variable "texture"
-		texture = gs_texrender_get_texture(data->render2);
+	// Each pass blurs horizontally, then vertically. Intermediate
+	// results are transient graph targets, so the pool aliases them
+	// onto two targets however many passes run, and the last pass
+	// renders straight into output_texrender.
+	const int passes = data->passes < 1 ? 1 : data->passes;
+	const int count = passes * 2 < RENDER_GRAPH_MAX_PASSES
+				  ? passes * 2
+				  : RENDER_GRAPH_MAX_PASSES;
+	box_area_pass_t steps[RENDER_GRAPH_MAX_PASSES];
+
+	render_graph_t *graph = &data->graph;
+	render_graph_begin(graph, &data->graph_pool);
+	const int output =
+		render_graph_import(graph, data->output_texrender, false);
+	int previous = -1;
+	for (int i = 0; i < count; i++) {
+		box_area_pass_t *step = &steps[i];
+		step->data = data;
+		step->texture = i == 0 ? texture : NULL;
+		step->radius = radius;
+		step->texel_step.x = i % 2 == 0 ? 1.0f / data->width : 0.0f;
+		step->texel_step.y = i % 2 == 0 ? 0.0f : 1.0f / data->height;
+
+		const int target =
+			i == count - 1
+				? output
+				: render_graph_create(graph, data->width,
+						      data->height,
+						      get_pipeline_format());
+		render_graph_add_pass(graph, "box area", &previous,
+				      i > 0 ? 1 : 0, target, box_area_pass,
+				      step);
+		previous = target;
+	}
+	render_graph_mark_sink(graph, output);
+	render_graph_execute(graph);
+}
 
-		// 3. Second Pass- Apply 1D blur kernel vertically.
-		image = gs_effect_get_param_by_name(effect, "image");
-		gs_effect_set_texture(image, texture);
+static void box_area_pass(void *param, gs_texrender_t *const *inputs,
+			  gs_texrender_t *output)
+{
+	const box_area_pass_t *step = param;
+	composite_blur_filter_data_t *data = step->data;
+	gs_effect_t *effect = data->effect;
+	gs_texture_t *texture = step->texture
+					? step->texture
+					: gs_texrender_get_texture(inputs[0]);
 
-		texel_step.x = 0.0f;
-		texel_step.y = 1.0f / data->height;
-		if (data->param_texel_step) {
-			gs_effect_set_vec2(data->param_texel_step, &texel_step);
-		}
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	gs_effect_set_texture(image, texture);
 
-		data->output_texrender =
-			create_or_reset_texrender(data->output_texrender);
+	if (data->param_radius) {
+		gs_effect_set_float(data->param_radius, step->radius);
+	}
+	if (data->param_texel_step) {
+		gs_effect_set_vec2(data->param_texel_step, &step->texel_step);
+	}
 
-		if (gs_texrender_begin(data->output_texrender, data->width,
-				       data->height)) {
-			gs_ortho(0.0f, (float)data->width, 0.0f,
-				 (float)data->height, -100.0f, 100.0f);
-			while (gs_effect_loop(effect, "Draw"))
-				gs_draw_sprite(texture, 0, data->width,
-					       data->height);
-			gs_texrender_end(data->output_texrender);
-		}
+	set_blending_parameters();
 
-		texture = gs_texrender_get_texture(data->output_texrender);
-		gs_blend_state_pop();
+	if (gs_texrender_begin(output, data->width, data->height)) {
+		stencil_pass_begin(data);
+		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
+			 -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "Draw"))
+			gs_draw_sprite(texture, 0, data->width, data->height);
+		stencil_pass_end(data);
+		gs_texrender_end(output);
 	}
+
+	gs_blend_state_pop();
 }
 
 /*
@@ -225,11 +245,13 @@ static void box_directional_blur(composite_blur_filter_data_t *data)
 
 		if (gs_texrender_begin(data->output_texrender, data->width,
 				       data->height)) {
+			stencil_pass_begin(data);
 			gs_ortho(0.0f, (float)data->width, 0.0f,
 				 (float)data->height, -100.0f, 100.0f);
 			while (gs_effect_loop(effect, "Draw"))
 				gs_draw_sprite(texture, 0, data->width,
 					       data->height);
+			stencil_pass_end(data);
 			gs_texrender_end(data->output_texrender);
 		}
 		texture = gs_texrender_get_texture(data->output_texrender);
@@ -434,6 +456,7 @@ static void load_1d_box_effect(composite_blur_filter_data_t *filter)
 
 	const char *effect_file_path = "/shaders/box_1d.effect";
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count = gs_effect_get_num_params(filter->effect);
 		for (size_t effect_index = 0; effect_index < effect_count;
@@ -446,6 +469,9 @@ static void load_1d_box_effect(composite_blur_filter_data_t *filter)
 				filter->param_texel_step = param;
 			} else if (strcmp(info.name, "radius") == 0) {
 				filter->param_radius = param;
+			} else if (strcmp(info.name, "dither_strength") == 0) {
+				effect_param_init(
+					&filter->param_dither_strength, param);
 			}
 		}
 	}
@@ -462,6 +488,7 @@ static void load_tiltshift_box_effect(composite_blur_filter_data_t *filter)
 
 	const char *effect_file_path = "/shaders/box_tiltshift.effect";
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count = gs_effect_get_num_params(filter->effect);
 		for (size_t effect_index = 0; effect_index < effect_count;
@@ -498,6 +525,7 @@ static void load_radial_box_effect(composite_blur_filter_data_t *filter)
 
 	const char *effect_file_path = "/shaders/box_radial.effect";
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count = gs_effect_get_num_params(filter->effect);
 		for (size_t effect_index = 0; effect_index < effect_count;
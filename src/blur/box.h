@@ -7,12 +7,23 @@
 
 #define MIN_BOX_BLUR_RADIUS 0.01f
 
+// One 1D pass of the box area blur. The first pass reads the composited
+// input texture, later passes the graph target of the previous pass.
+typedef struct box_area_pass {
+	composite_blur_filter_data_t *data;
+	gs_texture_t *texture;
+	float radius;
+	struct vec2 texel_step;
+} box_area_pass_t;
+
 extern void set_box_blur_types(obs_properties_t *props);
 extern void box_setup_callbacks(composite_blur_filter_data_t *data);
 extern void render_video_box(composite_blur_filter_data_t *data);
 extern void load_effect_box(composite_blur_filter_data_t *filter);
 
 static void box_area_blur(composite_blur_filter_data_t *data);
+static void box_area_pass(void *param, gs_texrender_t *const *inputs,
+			  gs_texrender_t *output);
 static void box_directional_blur(composite_blur_filter_data_t *data);
 static void box_zoom_blur(composite_blur_filter_data_t *data);
 // static void box_motion_blur(composite_blur_filter_data_t *data);
@@ -0,0 +1,970 @@
+#include "cpu_blur.h"
+
+#include <math.h>
+#include <util/sse-intrin.h>
+
+#define CPU_BLUR_ROUND (1 << (CPU_BLUR_SHIFT - 1))
+
+// Rows are handed to workers in chunks of at least this many.
+#define CPU_BLUR_MIN_ROWS 8
+// Column strips of the box blur's vertical pass, in bytes.
+#define CPU_BLUR_STRIP 64
+// Column strips of the recursive gaussian, one byte per float lane.
+#define CPU_BLUR_IIR_STRIP 16
+// Pixels per side of the blocks the recursive gaussian transposes.
+#define CPU_BLUR_TRANSPOSE_BLOCK 32
+
+typedef struct cpu_blur_job {
+	const cpu_plane_t *src;
+	cpu_plane_t *dst;
+	const int16_t *weights;
+	int radius;
+	uint32_t size_x;
+	uint32_t size_y;
+	const uint8_t *mask;
+	uint32_t mask_width;
+	uint32_t mask_height;
+	uint32_t shift_x;
+	uint32_t shift_y;
+	uint32_t alpha_channel;
+	bool unpremultiply;
+	float iir_b;
+	float iir_a[3];
+	float iir_m[9];
+} cpu_blur_job_t;
+
+/*
+ *  Samples a gaussian of the given sigma into fixed point weights for
+ *  taps 0..radius, trimming trailing taps that round to zero. Returns
+ *  the radius. Tap 0 absorbs the rounding, so the weights sum exactly
+ *  to 1 << CPU_BLUR_SHIFT and a flat image stays flat.
+ */
+static int cpu_gaussian_weights(float sigma, int16_t *weights)
+{
+	int radius = (int)ceilf(sigma * 3.0f);
+	radius = radius < 1 ? 1
+			    : (radius > CPU_BLUR_MAX_RADIUS ? CPU_BLUR_MAX_RADIUS
+							    : radius);
+
+	float samples[CPU_BLUR_MAX_RADIUS + 1];
+	float sum = 0.0f;
+	for (int k = 0; k <= radius; k++) {
+		samples[k] = expf(-(float)(k * k) / (2.0f * sigma * sigma));
+		sum += k == 0 ? samples[k] : 2.0f * samples[k];
+	}
+
+	while (radius > 1 &&
+	       lroundf(samples[radius] / sum * (1 << CPU_BLUR_SHIFT)) == 0) {
+		radius--;
+	}
+
+	int total = 0;
+	for (int k = 1; k <= radius; k++) {
+		weights[k] = (int16_t)lroundf(samples[k] / sum *
+					      (1 << CPU_BLUR_SHIFT));
+		total += 2 * weights[k];
+	}
+	weights[0] = (int16_t)((1 << CPU_BLUR_SHIFT) - total);
+	return radius;
+}
+
+// Widens the 8 bytes at p to 16 bit lanes.
+static inline __m128i gaussian_load8(const uint8_t *p)
+{
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)p),
+				 _mm_setzero_si128());
+}
+
+// Adds weight times the 16 bit lanes of p to the 32 bit sums acc0
+// (lanes 0-3) and acc1 (lanes 4-7).
+static inline void gaussian_madd8(__m128i p, int16_t weight, __m128i *acc0,
+				  __m128i *acc1)
+{
+	const __m128i w = _mm_set1_epi16(weight);
+	const __m128i lo = _mm_mullo_epi16(p, w);
+	const __m128i hi = _mm_mulhi_epi16(p, w);
+	*acc0 = _mm_add_epi32(*acc0, _mm_unpacklo_epi16(lo, hi));
+	*acc1 = _mm_add_epi32(*acc1, _mm_unpackhi_epi16(lo, hi));
+}
+
+// Rounds and shifts the sums back to 8 bit, and stores them at out.
+static inline void gaussian_store8(uint8_t *out, __m128i acc0, __m128i acc1)
+{
+	const __m128i round = _mm_set1_epi32(CPU_BLUR_ROUND);
+	acc0 = _mm_srai_epi32(_mm_add_epi32(acc0, round), CPU_BLUR_SHIFT);
+	acc1 = _mm_srai_epi32(_mm_add_epi32(acc1, round), CPU_BLUR_SHIFT);
+	const __m128i packed = _mm_packs_epi32(acc0, acc1);
+	_mm_storel_epi64((__m128i *)out, _mm_packus_epi16(packed, packed));
+}
+
+/*
+ *  Horizontal gaussian pass. Each row is copied into a buffer padded
+ *  with its edge pixels, so the taps need no clamping and 8 bytes can
+ *  be weighted at a time like in gaussian_columns. The taps of a byte
+ *  are whole pixels apart, so channels never mix.
+ */
+static void gaussian_rows(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *src = job->src;
+	const cpu_plane_t *dst = job->dst;
+	const uint32_t ch = src->channels;
+	const uint32_t bytes = src->width * ch;
+	const int radius = job->radius;
+	const int16_t *weights = job->weights;
+
+	uint8_t *padded = bmalloc((size_t)(src->width + 2 * radius) * ch);
+	uint8_t *center = padded + (size_t)radius * ch;
+
+	for (uint32_t y = start; y < end; y++) {
+		const uint8_t *row = src->data + (size_t)y * src->linesize;
+		memcpy(center, row, bytes);
+		for (int i = 1; i <= radius; i++) {
+			memcpy(center - (size_t)i * ch, row, ch);
+			memcpy(center + bytes + (size_t)(i - 1) * ch,
+			       row + bytes - ch, ch);
+		}
+
+		uint8_t *out = dst->data + (size_t)y * dst->linesize;
+		uint32_t x = 0;
+		// The furthest load ends at center + bytes + radius * ch,
+		// the end of the padding.
+		for (; x + 8 <= bytes; x += 8) {
+			const uint8_t *p = center + x;
+			__m128i acc0 = _mm_setzero_si128();
+			__m128i acc1 = _mm_setzero_si128();
+			gaussian_madd8(gaussian_load8(p), weights[0], &acc0,
+				       &acc1);
+			for (int k = 1; k <= radius; k++) {
+				const ptrdiff_t offset = (ptrdiff_t)k * ch;
+				gaussian_madd8(
+					_mm_add_epi16(
+						gaussian_load8(p - offset),
+						gaussian_load8(p + offset)),
+					weights[k], &acc0, &acc1);
+			}
+			gaussian_store8(out + x, acc0, acc1);
+		}
+		for (; x < bytes; x++) {
+			const uint8_t *p = center + x;
+			int32_t acc = weights[0] * p[0];
+			for (int k = 1; k <= radius; k++) {
+				const ptrdiff_t offset = (ptrdiff_t)k * ch;
+				acc += weights[k] * (p[-offset] + p[offset]);
+			}
+			out[x] = (uint8_t)((acc + CPU_BLUR_ROUND) >>
+					   CPU_BLUR_SHIFT);
+		}
+	}
+
+	bfree(padded);
+}
+
+/*
+ *  Vertical gaussian pass. Rows above and below are summed in pairs,
+ *  since the kernel is symmetric, and 8 bytes are weighted at a time
+ *  with SSE2 (NEON through sse-intrin.h on ARM).
+ */
+static void gaussian_columns(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *src = job->src;
+	const cpu_plane_t *dst = job->dst;
+	const uint32_t bytes = src->width * src->channels;
+	const int radius = job->radius;
+	const int16_t *weights = job->weights;
+	const int last = (int)src->height - 1;
+
+	const uint8_t *above[CPU_BLUR_MAX_RADIUS + 1];
+	const uint8_t *below[CPU_BLUR_MAX_RADIUS + 1];
+
+	for (uint32_t y = start; y < end; y++) {
+		for (int k = 0; k <= radius; k++) {
+			const int up = (int)y - k < 0 ? 0 : (int)y - k;
+			const int down = (int)y + k > last ? last : (int)y + k;
+			above[k] = src->data + (size_t)up * src->linesize;
+			below[k] = src->data + (size_t)down * src->linesize;
+		}
+
+		uint8_t *out = dst->data + (size_t)y * dst->linesize;
+		uint32_t x = 0;
+		for (; x + 8 <= bytes; x += 8) {
+			__m128i acc0 = _mm_setzero_si128();
+			__m128i acc1 = _mm_setzero_si128();
+			gaussian_madd8(gaussian_load8(above[0] + x), weights[0],
+				       &acc0, &acc1);
+			for (int k = 1; k <= radius; k++) {
+				gaussian_madd8(
+					_mm_add_epi16(
+						gaussian_load8(above[k] + x),
+						gaussian_load8(below[k] + x)),
+					weights[k], &acc0, &acc1);
+			}
+			gaussian_store8(out + x, acc0, acc1);
+		}
+		for (; x < bytes; x++) {
+			int32_t acc = weights[0] * above[0][x];
+			for (int k = 1; k <= radius; k++) {
+				acc += weights[k] * (above[k][x] + below[k][x]);
+			}
+			out[x] = (uint8_t)((acc + CPU_BLUR_ROUND) >>
+					   CPU_BLUR_SHIFT);
+		}
+	}
+}
+
+/*
+ *  Young & van Vliet, "Recursive implementation of the Gaussian
+ *  filter" (1995). Third order feedback coefficients for sigma, with
+ *  the gain b normalised so a flat signal passes unchanged. m maps the
+ *  last causal outputs to the anti-causal pass's initial state, as if
+ *  the edge pixel repeated forever (Triggs & Sdika, 2006).
+ *
+ *  The poles approach 1 as sigma grows, so b and the terms of m cancel
+ *  badly. They are derived in double precision, b from the rounded
+ *  feedback coefficients so the gain stays exactly 1.
+ */
+static void iir_coefficients(float sigma, cpu_blur_job_t *job)
+{
+	const double q = sigma >= 2.5f
+				 ? 0.98711 * sigma - 0.96330
+				 : 3.97156 - 4.14554 * sqrt(1.0 - 0.26891 *
+									sigma);
+	const double q2 = q * q;
+	const double q3 = q2 * q;
+	const double b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 +
+			  0.422205 * q3;
+	job->iir_a[0] = (float)((2.44413 * q + 2.85619 * q2 + 1.26661 * q3) /
+				b0);
+	job->iir_a[1] = (float)(-(1.4281 * q2 + 1.26661 * q3) / b0);
+	job->iir_a[2] = (float)(0.422205 * q3 / b0);
+
+	const double a1 = job->iir_a[0];
+	const double a2 = job->iir_a[1];
+	const double a3 = job->iir_a[2];
+	const double b = 1.0 - (a1 + a2 + a3);
+	job->iir_b = (float)b;
+
+	const double scale = b / ((1.0 + a1 - a2 + a3) * b *
+				  (1.0 + a2 + (a1 - a3) * a3));
+	const double m[9] = {
+		scale * (-a3 * a1 + 1.0 - a3 * a3 - a2),
+		scale * (a3 + a1) * (a2 + a3 * a1),
+		scale * a3 * (a1 + a3 * a2),
+		scale * (a1 + a3 * a2),
+		-scale * (a2 - 1.0) * (a2 + a3 * a1),
+		-scale * a3 * (a3 * a1 + a3 * a3 + a2 - 1.0),
+		scale * (a3 * a1 + a2 + a1 * a1 - a2 * a2),
+		scale * (a1 * a2 + a3 * a2 * a2 - a1 * a3 * a3 -
+			 a3 * a3 * a3 - a3 * a2 + a3),
+		scale * a3 * (a1 + a3 * a2),
+	};
+	for (int k = 0; k < 9; k++) {
+		job->iir_m[k] = (float)m[k];
+	}
+}
+
+// k0 * v0 + k1 * v1 + k2 * v2 + k3 * v3, the step of both IIR passes.
+static inline __m128 iir_madd(__m128 k0, __m128 v0, __m128 k1, __m128 v1,
+			      __m128 k2, __m128 v2, __m128 k3, __m128 v3)
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(k0, v0), _mm_mul_ps(k1, v1)),
+			  _mm_add_ps(_mm_mul_ps(k2, v2), _mm_mul_ps(k3, v3)));
+}
+
+/*
+ *  Recursive gaussian down strips of 16 bytes, in place. Each byte of
+ *  a row is an independent lane, so the 16 columns (or channels) of a
+ *  strip run as four float vectors. The causal pass runs down into a
+ *  float buffer and the anti-causal pass back up into the plane. Both
+ *  start from the state a clamped edge would leave them in.
+ */
+static void iir_columns(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *plane = job->dst;
+	const uint32_t bytes = plane->width * plane->channels;
+	const uint32_t h = plane->height;
+	const __m128 b = _mm_set1_ps(job->iir_b);
+	const __m128 a1 = _mm_set1_ps(job->iir_a[0]);
+	const __m128 a2 = _mm_set1_ps(job->iir_a[1]);
+	const __m128 a3 = _mm_set1_ps(job->iir_a[2]);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128i zero = _mm_setzero_si128();
+	__m128 m[9];
+	for (int k = 0; k < 9; k++) {
+		m[k] = _mm_set1_ps(job->iir_m[k]);
+	}
+
+	float *causal = bmalloc(sizeof(float) * CPU_BLUR_IIR_STRIP * h);
+	uint8_t lane_bytes[CPU_BLUR_IIR_STRIP] = {0};
+
+	for (uint32_t strip = start; strip < end; strip++) {
+		const uint32_t x0 = strip * CPU_BLUR_IIR_STRIP;
+		const uint32_t n = bytes - x0 < CPU_BLUR_IIR_STRIP
+					   ? bytes - x0
+					   : CPU_BLUR_IIR_STRIP;
+
+		__m128 x[4], w1[4], w2[4], w3[4];
+		for (uint32_t y = 0; y < h; y++) {
+			const uint8_t *row =
+				plane->data + (size_t)y * plane->linesize + x0;
+			memcpy(lane_bytes, row, n);
+			const __m128i v =
+				_mm_loadu_si128((const __m128i *)lane_bytes);
+			const __m128i lo = _mm_unpacklo_epi8(v, zero);
+			const __m128i hi = _mm_unpackhi_epi8(v, zero);
+			x[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+			x[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+			x[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+			x[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+
+			float *out = causal + (size_t)y * CPU_BLUR_IIR_STRIP;
+			for (int i = 0; i < 4; i++) {
+				if (y == 0) {
+					w1[i] = w2[i] = w3[i] = x[i];
+				}
+				const __m128 w = iir_madd(b, x[i], a1, w1[i],
+							  a2, w2[i], a3, w3[i]);
+				w3[i] = w2[i];
+				w2[i] = w1[i];
+				w1[i] = w;
+				_mm_storeu_ps(out + 4 * i, w);
+			}
+		}
+
+		// x still holds the last row, the edge the state starts from.
+		const uint32_t last = h - 1;
+		const float *c0 = causal + (size_t)last * CPU_BLUR_IIR_STRIP;
+		const float *c1 = causal + (size_t)(last > 0 ? last - 1 : 0) *
+						   CPU_BLUR_IIR_STRIP;
+		const float *c2 = causal + (size_t)(last > 1 ? last - 2 : 0) *
+						   CPU_BLUR_IIR_STRIP;
+		for (int i = 0; i < 4; i++) {
+			const __m128 u0 =
+				_mm_sub_ps(_mm_loadu_ps(c0 + 4 * i), x[i]);
+			const __m128 u1 =
+				_mm_sub_ps(_mm_loadu_ps(c1 + 4 * i), x[i]);
+			const __m128 u2 =
+				_mm_sub_ps(_mm_loadu_ps(c2 + 4 * i), x[i]);
+			w1[i] = iir_madd(one, x[i], m[0], u0, m[1], u1,
+					 m[2], u2);
+			w2[i] = iir_madd(one, x[i], m[3], u0, m[4], u1,
+					 m[5], u2);
+			w3[i] = iir_madd(one, x[i], m[6], u0, m[7], u1,
+					 m[8], u2);
+		}
+
+		for (uint32_t y = h; y-- > 0;) {
+			const float *in =
+				causal + (size_t)y * CPU_BLUR_IIR_STRIP;
+			__m128i result[4];
+			for (int i = 0; i < 4; i++) {
+				if (y < last) {
+					const __m128 w =
+						_mm_loadu_ps(in + 4 * i);
+					const __m128 o =
+						iir_madd(b, w, a1, w1[i], a2,
+							 w2[i], a3, w3[i]);
+					w3[i] = w2[i];
+					w2[i] = w1[i];
+					w1[i] = o;
+				}
+				result[i] = _mm_cvtps_epi32(w1[i]);
+			}
+			const __m128i packed = _mm_packus_epi16(
+				_mm_packs_epi32(result[0], result[1]),
+				_mm_packs_epi32(result[2], result[3]));
+			_mm_storeu_si128((__m128i *)lane_bytes, packed);
+			memcpy(plane->data + (size_t)y * plane->linesize + x0,
+			       lane_bytes, n);
+		}
+	}
+
+	bfree(causal);
+}
+
+// Transposes blocks of pixels of src into dst, a block row at a time.
+static void transpose_blocks(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *src = job->src;
+	const cpu_plane_t *dst = job->dst;
+	const uint32_t ch = src->channels;
+
+	for (uint32_t block_y = start; block_y < end; block_y++) {
+		const uint32_t y0 = block_y * CPU_BLUR_TRANSPOSE_BLOCK;
+		const uint32_t y1 = y0 + CPU_BLUR_TRANSPOSE_BLOCK < src->height
+					    ? y0 + CPU_BLUR_TRANSPOSE_BLOCK
+					    : src->height;
+		for (uint32_t x0 = 0; x0 < src->width;
+		     x0 += CPU_BLUR_TRANSPOSE_BLOCK) {
+			const uint32_t x1 =
+				x0 + CPU_BLUR_TRANSPOSE_BLOCK < src->width
+					? x0 + CPU_BLUR_TRANSPOSE_BLOCK
+					: src->width;
+			for (uint32_t y = y0; y < y1; y++) {
+				const uint8_t *p = src->data +
+						   (size_t)y * src->linesize +
+						   (size_t)x0 * ch;
+				uint8_t *q = dst->data +
+					     (size_t)x0 * dst->linesize +
+					     (size_t)y * ch;
+				for (uint32_t x = x0; x < x1; x++) {
+					for (uint32_t c = 0; c < ch; c++) {
+						q[c] = p[c];
+					}
+					p += ch;
+					q += dst->linesize;
+				}
+			}
+		}
+	}
+}
+
+static void transpose_plane(thread_pool_t *pool, const cpu_plane_t *src,
+			    cpu_plane_t *dst)
+{
+	cpu_blur_job_t job = {0};
+	job.src = src;
+	job.dst = dst;
+	const uint32_t blocks = (src->height + CPU_BLUR_TRANSPOSE_BLOCK - 1) /
+				CPU_BLUR_TRANSPOSE_BLOCK;
+	thread_pool_run(pool, blocks, 1, transpose_blocks, &job);
+}
+
+static void iir_plane(thread_pool_t *pool, cpu_plane_t *plane, float sigma)
+{
+	cpu_blur_job_t job = {0};
+	job.dst = plane;
+	iir_coefficients(sigma, &job);
+	const uint32_t bytes = plane->width * plane->channels;
+	const uint32_t strips =
+		(bytes + CPU_BLUR_IIR_STRIP - 1) / CPU_BLUR_IIR_STRIP;
+	thread_pool_run(pool, strips, 1, iir_columns, &job);
+}
+
+static void copy_plane(const cpu_plane_t *src, cpu_plane_t *dst)
+{
+	const size_t bytes = (size_t)src->width * src->channels;
+	for (uint32_t y = 0; y < src->height; y++) {
+		memcpy(dst->data + (size_t)y * dst->linesize,
+		       src->data + (size_t)y * src->linesize, bytes);
+	}
+}
+
+// One direction of the sampled kernel, src into dst, with task being
+// gaussian_rows or gaussian_columns.
+static void fir_plane(thread_pool_t *pool, const cpu_plane_t *src,
+		      cpu_plane_t *dst, float sigma, thread_pool_task_fn task)
+{
+	int16_t weights[CPU_BLUR_MAX_RADIUS + 1];
+	cpu_blur_job_t job = {0};
+	job.src = src;
+	job.dst = dst;
+	job.weights = weights;
+	job.radius = cpu_gaussian_weights(sigma, weights);
+	thread_pool_run(pool, src->height, CPU_BLUR_MIN_ROWS, task, &job);
+}
+
+// Horizontal recursive pass, run as a vertical one on a transposed
+// copy in temp. src may be dst.
+static void iir_rows_plane(thread_pool_t *pool, const cpu_plane_t *src,
+			   cpu_plane_t *dst, uint8_t *temp, float sigma)
+{
+	cpu_plane_t transposed = {temp, src->height * src->channels,
+				  src->height, src->width, src->channels};
+	transpose_plane(pool, src, &transposed);
+	iir_plane(pool, &transposed, sigma);
+	transpose_plane(pool, &transposed, dst);
+}
+
+/*
+ *  Recursive gaussian, constant cost per pixel whatever the sigma. The
+ *  vertical pass runs in place on dst. The horizontal pass runs as a
+ *  vertical one on a transposed copy in temp, so both stay vectorised
+ *  across rows of bytes. A sigma below CPU_BLUR_IIR_MIN_SIGMA_PASS
+ *  skips that direction.
+ */
+void cpu_blur_gaussian_iir(thread_pool_t *pool, const cpu_plane_t *src,
+			   cpu_plane_t *dst, uint8_t *temp, float sigma_x,
+			   float sigma_y)
+{
+	if (sigma_x >= CPU_BLUR_IIR_MIN_SIGMA_PASS) {
+		iir_rows_plane(pool, src, dst, temp, sigma_x);
+	} else {
+		copy_plane(src, dst);
+	}
+
+	if (sigma_y >= CPU_BLUR_IIR_MIN_SIGMA_PASS) {
+		iir_plane(pool, dst, sigma_y);
+	}
+}
+
+/*
+ *  Separable gaussian blur with a sampled kernel, horizontally into
+ *  temp then vertically into dst. A sigma below 0.1 skips that
+ *  direction. The kernel is cut at CPU_BLUR_MAX_RADIUS.
+ */
+void cpu_blur_gaussian_fir(thread_pool_t *pool, const cpu_plane_t *src,
+			   cpu_plane_t *dst, uint8_t *temp, float sigma_x,
+			   float sigma_y)
+{
+	cpu_plane_t tmp = {temp, src->width * src->channels, src->width,
+			   src->height, src->channels};
+
+	if (sigma_x >= 0.1f) {
+		fir_plane(pool, src, &tmp, sigma_x, gaussian_rows);
+	} else {
+		copy_plane(src, &tmp);
+	}
+
+	if (sigma_y >= 0.1f) {
+		fir_plane(pool, &tmp, dst, sigma_y, gaussian_columns);
+	} else {
+		copy_plane(&tmp, dst);
+	}
+}
+
+/*
+ *  Sigmas are in plane pixels, so subsampled chroma planes pass the
+ *  luma sigma scaled down. From CPU_BLUR_IIR_MIN_SIGMA on, the
+ *  recursive filter is cheaper than the kernel. The choice is made per
+ *  direction, so a small sigma next to a large one still gets the
+ *  kernel rather than being skipped by the recursive filter. Mixed
+ *  directions write straight to dst: the kernel pass goes first, then
+ *  the recursive pass runs in place.
+ */
+void cpu_blur_gaussian(thread_pool_t *pool, const cpu_plane_t *src,
+		       cpu_plane_t *dst, uint8_t *temp, float sigma_x,
+		       float sigma_y)
+{
+	const bool iir_x = sigma_x >= CPU_BLUR_IIR_MIN_SIGMA;
+	const bool iir_y = sigma_y >= CPU_BLUR_IIR_MIN_SIGMA;
+	if (iir_x && iir_y) {
+		cpu_blur_gaussian_iir(pool, src, dst, temp, sigma_x, sigma_y);
+	} else if (!iir_x && !iir_y) {
+		cpu_blur_gaussian_fir(pool, src, dst, temp, sigma_x, sigma_y);
+	} else if (iir_y) {
+		if (sigma_x >= 0.1f) {
+			fir_plane(pool, src, dst, sigma_x, gaussian_rows);
+		} else {
+			copy_plane(src, dst);
+		}
+		iir_plane(pool, dst, sigma_y);
+	} else if (sigma_y >= 0.1f) {
+		fir_plane(pool, src, dst, sigma_y, gaussian_columns);
+		iir_rows_plane(pool, dst, dst, temp, sigma_x);
+	} else {
+		iir_rows_plane(pool, src, dst, temp, sigma_x);
+	}
+}
+
+// Divides a window sum by size with rounding, via a 32.32 reciprocal.
+static inline uint8_t box_average(uint32_t sum, uint32_t size,
+				  uint64_t reciprocal)
+{
+	return (uint8_t)(((uint64_t)(sum + size / 2) * reciprocal) >> 32);
+}
+
+// Horizontal box pass as a running sum, clamping at the edges.
+static void box_rows(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *src = job->src;
+	const cpu_plane_t *dst = job->dst;
+	const uint32_t ch = src->channels;
+	const int w = (int)src->width;
+	const int r = job->radius;
+	const uint32_t size = 2 * r + 1;
+	const uint64_t reciprocal = ((1ULL << 32) + size - 1) / size;
+
+	for (uint32_t y = start; y < end; y++) {
+		const uint8_t *row = src->data + (size_t)y * src->linesize;
+		uint8_t *out = dst->data + (size_t)y * dst->linesize;
+		for (uint32_t c = 0; c < ch; c++) {
+			uint32_t sum = row[c] * (uint32_t)(r + 1);
+			for (int k = 1; k <= r; k++) {
+				sum += row[(k < w ? k : w - 1) * ch + c];
+			}
+			for (int x = 0; x < w; x++) {
+				out[x * ch + c] =
+					box_average(sum, size, reciprocal);
+				const int add = x + r + 1 < w ? x + r + 1 : w - 1;
+				const int sub = x - r > 0 ? x - r : 0;
+				sum += row[add * ch + c];
+				sum -= row[sub * ch + c];
+			}
+		}
+	}
+}
+
+// Vertical box pass over strips of columns, keeping one running sum
+// per byte of the strip while walking down the rows.
+static void box_columns(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *src = job->src;
+	const cpu_plane_t *dst = job->dst;
+	const uint32_t bytes = src->width * src->channels;
+	const int h = (int)src->height;
+	const int r = job->radius;
+	const uint32_t size = 2 * r + 1;
+	const uint64_t reciprocal = ((1ULL << 32) + size - 1) / size;
+
+	uint32_t sums[CPU_BLUR_STRIP];
+	for (uint32_t strip = start; strip < end; strip++) {
+		const uint32_t x0 = strip * CPU_BLUR_STRIP;
+		const uint32_t x1 = x0 + CPU_BLUR_STRIP < bytes
+					    ? x0 + CPU_BLUR_STRIP
+					    : bytes;
+		const uint32_t n = x1 - x0;
+
+		const uint8_t *first = src->data + x0;
+		for (uint32_t i = 0; i < n; i++) {
+			sums[i] = first[i] * (uint32_t)(r + 1);
+		}
+		for (int k = 1; k <= r; k++) {
+			const uint8_t *row = src->data +
+					     (size_t)(k < h ? k : h - 1) *
+						     src->linesize +
+					     x0;
+			for (uint32_t i = 0; i < n; i++) {
+				sums[i] += row[i];
+			}
+		}
+
+		for (int y = 0; y < h; y++) {
+			uint8_t *out = dst->data + (size_t)y * dst->linesize + x0;
+			for (uint32_t i = 0; i < n; i++) {
+				out[i] = box_average(sums[i], size, reciprocal);
+			}
+			const int add = y + r + 1 < h ? y + r + 1 : h - 1;
+			const int sub = y - r > 0 ? y - r : 0;
+			const uint8_t *add_row =
+				src->data + (size_t)add * src->linesize + x0;
+			const uint8_t *sub_row =
+				src->data + (size_t)sub * src->linesize + x0;
+			for (uint32_t i = 0; i < n; i++) {
+				sums[i] += add_row[i];
+				sums[i] -= sub_row[i];
+			}
+		}
+	}
+}
+
+/*
+ *  Box blur of the given radii, repeated passes times. Each pass costs
+ *  the same whatever the radius, and three passes come close to a
+ *  gaussian.
+ */
+void cpu_blur_box(thread_pool_t *pool, const cpu_plane_t *src,
+		  cpu_plane_t *dst, uint8_t *temp, int radius_x, int radius_y,
+		  int passes)
+{
+	cpu_plane_t tmp = {temp, src->width * src->channels, src->width,
+			   src->height, src->channels};
+	const uint32_t bytes = src->width * src->channels;
+	const uint32_t strips = (bytes + CPU_BLUR_STRIP - 1) / CPU_BLUR_STRIP;
+	radius_x = radius_x > 0 ? radius_x : 0;
+	radius_y = radius_y > 0 ? radius_y : 0;
+	passes = passes > 0 ? passes : 1;
+
+	cpu_blur_job_t job = {0};
+	for (int i = 0; i < passes; i++) {
+		job.src = i == 0 ? src : dst;
+		job.dst = &tmp;
+		job.radius = radius_x;
+		thread_pool_run(pool, src->height, CPU_BLUR_MIN_ROWS, box_rows,
+				&job);
+
+		job.src = &tmp;
+		job.dst = dst;
+		job.radius = radius_y;
+		thread_pool_run(pool, strips, 1, box_columns, &job);
+	}
+}
+
+// Averages each cell of a row of cells, then fills the cell with it.
+static void pixelate_cells(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *src = job->src;
+	const cpu_plane_t *dst = job->dst;
+	const uint32_t ch = src->channels;
+
+	for (uint32_t cell_y = start; cell_y < end; cell_y++) {
+		const uint32_t y0 = cell_y * job->size_y;
+		const uint32_t y1 = y0 + job->size_y < src->height
+					    ? y0 + job->size_y
+					    : src->height;
+		for (uint32_t x0 = 0; x0 < src->width; x0 += job->size_x) {
+			const uint32_t x1 = x0 + job->size_x < src->width
+						    ? x0 + job->size_x
+						    : src->width;
+			uint32_t sum[4] = {0, 0, 0, 0};
+			for (uint32_t y = y0; y < y1; y++) {
+				const uint8_t *p = src->data +
+						   (size_t)y * src->linesize +
+						   (size_t)x0 * ch;
+				for (uint32_t x = x0; x < x1; x++) {
+					for (uint32_t c = 0; c < ch; c++) {
+						sum[c] += p[c];
+					}
+					p += ch;
+				}
+			}
+
+			const uint32_t count = (y1 - y0) * (x1 - x0);
+			uint8_t average[4];
+			for (uint32_t c = 0; c < ch; c++) {
+				average[c] =
+					(uint8_t)((sum[c] + count / 2) / count);
+			}
+			for (uint32_t y = y0; y < y1; y++) {
+				uint8_t *p = dst->data +
+					     (size_t)y * dst->linesize +
+					     (size_t)x0 * ch;
+				for (uint32_t x = x0; x < x1; x++) {
+					memcpy(p, average, ch);
+					p += ch;
+				}
+			}
+		}
+	}
+}
+
+// Square cells anchored at the top left corner, sizes in plane pixels.
+void cpu_pixelate(thread_pool_t *pool, const cpu_plane_t *src,
+		  cpu_plane_t *dst, uint32_t cell_width, uint32_t cell_height)
+{
+	cpu_blur_job_t job = {0};
+	job.src = src;
+	job.dst = dst;
+	job.size_x = cell_width > 0 ? cell_width : 1;
+	job.size_y = cell_height > 0 ? cell_height : 1;
+	const uint32_t rows = (src->height + job.size_y - 1) / job.size_y;
+	thread_pool_run(pool, rows, 1, pixelate_cells, &job);
+}
+
+static inline uint8_t mask_weight(float blur)
+{
+	blur = blur < 0.0f ? 0.0f : (blur > 1.0f ? 1.0f : blur);
+	return (uint8_t)(blur * 255.0f + 0.5f);
+}
+
+/*
+ *  Box from left/top to (1 - right)/(1 - bottom), in fractions of the
+ *  frame, matching effect_mask_crop.effect without rounded corners.
+ *  Feathering fades the blur in over that fraction of the distance
+ *  from the edge to the box center.
+ */
+void cpu_mask_box(uint8_t *mask, uint32_t width, uint32_t height, float left,
+		  float top, float right, float bottom, float feathering,
+		  bool invert)
+{
+	const float x0 = left * (float)width;
+	const float x1 = (1.0f - right) * (float)width;
+	const float y0 = top * (float)height;
+	const float y1 = (1.0f - bottom) * (float)height;
+	const float box_w = x1 - x0;
+	const float box_h = y1 - y0;
+	const float half = fminf(box_w, box_h) / 2.0f;
+
+	for (uint32_t y = 0; y < height; y++) {
+		const float py = (float)y + 0.5f;
+		for (uint32_t x = 0; x < width; x++) {
+			const float px = (float)x + 0.5f;
+			float blur = 0.0f;
+			if (box_w > 0.0f && box_h > 0.0f && px >= x0 &&
+			    px <= x1 && py >= y0 && py <= y1) {
+				const float edge = fminf(fminf(px - x0, x1 - px),
+							 fminf(py - y0, y1 - py));
+				const float distance = half > 0.0f ? edge / half
+								   : 1.0f;
+				blur = feathering > 0.0f ? distance / feathering
+							 : 1.0f;
+			}
+			mask[(size_t)y * width + x] =
+				mask_weight(invert ? 1.0f - fminf(blur, 1.0f)
+						   : blur);
+		}
+	}
+}
+
+/*
+ *  Circle with center and radius in fractions of the frame's shorter
+ *  side, matching effect_mask_circle.effect. Feathering fades the blur
+ *  out over the outer fraction of the radius.
+ */
+void cpu_mask_circle(uint8_t *mask, uint32_t width, uint32_t height,
+		     float center_x, float center_y, float radius,
+		     float feathering, bool invert)
+{
+	const float unit = (float)(width < height ? width : height);
+	const float cx = center_x * (float)width;
+	const float cy = center_y * (float)height;
+
+	for (uint32_t y = 0; y < height; y++) {
+		const float dy = ((float)y + 0.5f - cy) / unit;
+		for (uint32_t x = 0; x < width; x++) {
+			const float dx = ((float)x + 0.5f - cx) / unit;
+			const float distance = sqrtf(dx * dx + dy * dy);
+			float blur = 0.0f;
+			if (distance <= radius) {
+				blur = 1.0f;
+				const float factor =
+					radius > 0.0f ? distance / radius : 0.0f;
+				if (feathering > 0.0f &&
+				    factor > 1.0f - feathering) {
+					blur = 1.0f - (factor -
+						       (1.0f - feathering)) /
+							      feathering;
+				}
+			}
+			mask[(size_t)y * width + x] =
+				mask_weight(invert ? 1.0f - blur : blur);
+		}
+	}
+}
+
+static void blend_mask_rows(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *original = job->src;
+	const cpu_plane_t *dst = job->dst;
+	const uint32_t ch = dst->channels;
+
+	for (uint32_t y = start; y < end; y++) {
+		uint32_t mask_y = y << job->shift_y;
+		mask_y = mask_y < job->mask_height ? mask_y
+						   : job->mask_height - 1;
+		const uint8_t *weights =
+			job->mask + (size_t)mask_y * job->mask_width;
+		const uint8_t *in =
+			original->data + (size_t)y * original->linesize;
+		uint8_t *out = dst->data + (size_t)y * dst->linesize;
+
+		for (uint32_t x = 0; x < dst->width; x++) {
+			uint32_t mask_x = x << job->shift_x;
+			mask_x = mask_x < job->mask_width ? mask_x
+							  : job->mask_width - 1;
+			const int weight = weights[mask_x];
+			if (weight == 0) {
+				memcpy(out, in, ch);
+			} else if (weight < 255) {
+				for (uint32_t c = 0; c < ch; c++) {
+					const int delta = out[c] - in[c];
+					out[c] = (uint8_t)(in[c] +
+							   (delta * weight +
+							    (delta < 0 ? -127
+								       : 127)) /
+								   255);
+				}
+			}
+			in += ch;
+			out += ch;
+		}
+	}
+}
+
+/*
+ *  Mixes original back into the blurred dst by the mask. Planes
+ *  subsampled by shift_x/shift_y sample the mask at their top left
+ *  luma pixel.
+ */
+void cpu_blend_mask(thread_pool_t *pool, const cpu_plane_t *original,
+		    cpu_plane_t *dst, const uint8_t *mask, uint32_t mask_width,
+		    uint32_t mask_height, uint32_t shift_x, uint32_t shift_y)
+{
+	if (!mask || mask_width == 0 || mask_height == 0) {
+		return;
+	}
+	cpu_blur_job_t job = {0};
+	job.src = original;
+	job.dst = dst;
+	job.mask = mask;
+	job.mask_width = mask_width;
+	job.mask_height = mask_height;
+	job.shift_x = shift_x;
+	job.shift_y = shift_y;
+	thread_pool_run(pool, dst->height, CPU_BLUR_MIN_ROWS, blend_mask_rows,
+			&job);
+}
+
+/*
+ *  Multiplies (or divides) the color bytes of job->dst by the alpha
+ *  byte at alpha_channel of the same pixel of job->src, which may be
+ *  the same plane, in which case its alpha bytes are left alone.
+ *  Opaque pixels are skipped, and a fully transparent pixel stays at
+ *  zero when divided.
+ */
+static void premultiply_rows(void *param, uint32_t start, uint32_t end)
+{
+	const cpu_blur_job_t *job = param;
+	const cpu_plane_t *alpha = job->src;
+	const cpu_plane_t *color = job->dst;
+	const uint32_t ch = color->channels;
+	const bool shared = alpha->data == color->data;
+
+	for (uint32_t y = start; y < end; y++) {
+		const uint8_t *a_row = alpha->data +
+				       (size_t)y * alpha->linesize +
+				       job->alpha_channel;
+		uint8_t *row = color->data + (size_t)y * color->linesize;
+		for (uint32_t x = 0; x < color->width; x++) {
+			const uint32_t a = a_row[x * alpha->channels];
+			uint8_t *p = row + (size_t)x * ch;
+			if (a == 255) {
+				continue;
+			}
+			for (uint32_t c = 0; c < ch; c++) {
+				if (shared && c == job->alpha_channel) {
+					continue;
+				}
+				if (!job->unpremultiply) {
+					p[c] = (uint8_t)((p[c] * a + 127) /
+							 255);
+				} else if (a > 0) {
+					const uint32_t v =
+						(p[c] * 255 + a / 2) / a;
+					p[c] = (uint8_t)(v < 255 ? v : 255);
+				}
+			}
+		}
+	}
+}
+
+// True if every alpha byte at channel of plane is 255.
+bool cpu_alpha_opaque(const cpu_plane_t *alpha, uint32_t channel)
+{
+	for (uint32_t y = 0; y < alpha->height; y++) {
+		const uint8_t *row =
+			alpha->data + (size_t)y * alpha->linesize + channel;
+		for (uint32_t x = 0; x < alpha->width; x++) {
+			if (row[x * alpha->channels] != 255) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/*
+ *  Converts color between straight and premultiplied alpha in place,
+ *  so the blurs weight each pixel by its alpha and transparent pixels
+ *  don't bleed their color into opaque ones. alpha must be the size of
+ *  color, and may be color itself for packed formats.
+ */
+void cpu_premultiply(thread_pool_t *pool, cpu_plane_t *color,
+		     const cpu_plane_t *alpha, uint32_t alpha_channel,
+		     bool unpremultiply)
+{
+	cpu_blur_job_t job = {0};
+	job.src = alpha;
+	job.dst = color;
+	job.alpha_channel = alpha_channel;
+	job.unpremultiply = unpremultiply;
+	thread_pool_run(pool, color->height, CPU_BLUR_MIN_ROWS,
+			premultiply_rows, &job);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <obs-module.h>
+#include "../thread-pool.h"
+
+// Largest kernel half width, in plane pixels, used by the CPU blurs.
+#define CPU_BLUR_MAX_RADIUS 250
+
+// Sigma from which cpu_blur_gaussian switches from the sampled kernel
+// to the recursive filter, and the smallest sigma the recursive filter
+// blurs a direction with (its coefficients only hold from 0.5 on).
+#define CPU_BLUR_IIR_MIN_SIGMA 3.0f
+#define CPU_BLUR_IIR_MIN_SIGMA_PASS 0.5f
+
+// Fixed point precision of the gaussian weights. Weights sum to
+// 1 << CPU_BLUR_SHIFT and stay below 1 << 15, so 16 bit pixel sums
+// times a weight fit a signed 32 bit product.
+#define CPU_BLUR_SHIFT 14
+
+// One plane of a video frame. channels bytes are interleaved per
+// pixel, e.g. 1 for Y, 2 for NV12 UV, 4 for BGRA.
+typedef struct cpu_plane {
+	uint8_t *data;
+	uint32_t linesize;
+	uint32_t width;
+	uint32_t height;
+	uint32_t channels;
+} cpu_plane_t;
+
+// Blur src into dst, which must be the same size. temp must hold
+// width * channels * height bytes. cpu_blur_gaussian picks the sampled
+// kernel (fir) or the recursive filter (iir) per direction by sigma.
+extern void cpu_blur_gaussian(thread_pool_t *pool, const cpu_plane_t *src,
+			      cpu_plane_t *dst, uint8_t *temp, float sigma_x,
+			      float sigma_y);
+extern void cpu_blur_gaussian_fir(thread_pool_t *pool,
+				  const cpu_plane_t *src, cpu_plane_t *dst,
+				  uint8_t *temp, float sigma_x, float sigma_y);
+extern void cpu_blur_gaussian_iir(thread_pool_t *pool,
+				  const cpu_plane_t *src, cpu_plane_t *dst,
+				  uint8_t *temp, float sigma_x, float sigma_y);
+extern void cpu_blur_box(thread_pool_t *pool, const cpu_plane_t *src,
+			 cpu_plane_t *dst, uint8_t *temp, int radius_x,
+			 int radius_y, int passes);
+extern void cpu_pixelate(thread_pool_t *pool, const cpu_plane_t *src,
+			 cpu_plane_t *dst, uint32_t cell_width,
+			 uint32_t cell_height);
+
+// Mask of blur weights (0 keeps the original, 255 the blurred pixel),
+// one byte per pixel at the size of the frame's first plane.
+extern void cpu_mask_box(uint8_t *mask, uint32_t width, uint32_t height,
+			 float left, float top, float right, float bottom,
+			 float feathering, bool invert);
+extern void cpu_mask_circle(uint8_t *mask, uint32_t width, uint32_t height,
+			    float center_x, float center_y, float radius,
+			    float feathering, bool invert);
+extern void cpu_blend_mask(thread_pool_t *pool, const cpu_plane_t *original,
+			   cpu_plane_t *dst, const uint8_t *mask,
+			   uint32_t mask_width, uint32_t mask_height,
+			   uint32_t shift_x, uint32_t shift_y);
+
+// Alpha is the byte at alpha_channel of each pixel of alpha, which
+// has the size of color. unpremultiply converts back to straight alpha.
+extern bool cpu_alpha_opaque(const cpu_plane_t *alpha, uint32_t channel);
+extern void cpu_premultiply(thread_pool_t *pool, cpu_plane_t *color,
+			    const cpu_plane_t *alpha, uint32_t alpha_channel,
+			    bool unpremultiply);
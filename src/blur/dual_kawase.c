@@ -48,105 +48,86 @@ void load_effect_dual_kawase(composite_blur_filter_data_t *filter)
 	load_dual_kawase_up_sample_effect(filter);
 }
 
-gs_texture_t *down_sample(composite_blur_filter_data_t *data,
-			  gs_texture_t *input_texture, int divisor, float ratio)
+/*
+ *  Swaps render and render2, returning render reset to format for an
+ *  intermediate up sample step. render2 then holds the previous step.
+ */
+static gs_texrender_t *up_sample_target(composite_blur_filter_data_t *data,
+					enum gs_color_format format)
 {
-	gs_effect_t *effect_down = data->effect_2;
-	// Swap renderers
 	gs_texrender_t *tmp = data->render;
 	data->render = data->render2;
 	data->render2 = tmp;
 
-	data->render = create_or_reset_texrender(data->render);
-
-	uint32_t w = data->width / divisor;
-	uint32_t h = data->height / divisor;
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect_down, "image");
-	gs_effect_set_texture(image, input_texture);
-
-	gs_eparam_t *texel_step =
-		gs_effect_get_param_by_name(effect_down, "texel_step");
-	struct vec2 texel_step_size;
-
-	texel_step_size.x = ratio / (float)w;
-	texel_step_size.y = ratio / (float)h;
-	gs_effect_set_vec2(texel_step, &texel_step_size);
-
-	if (gs_texrender_begin(data->render, w, h)) {
-		gs_ortho(0.0f, (float)w, 0.0f, (float)h, -100.0f, 100.0f);
-		while (gs_effect_loop(effect_down, "Draw"))
-			gs_draw_sprite(input_texture, 0, w, h);
-		gs_texrender_end(data->render);
-	}
-	return gs_texrender_get_texture(data->render);
+	data->render = create_or_reset_texrender_format(data->render, format);
+	return data->render;
 }
 
 gs_texture_t *up_sample(composite_blur_filter_data_t *data,
-			gs_texture_t *input_texture, int divisor, float ratio)
+			gs_texture_t *input_texture, gs_texrender_t *target,
+			uint32_t base_width, uint32_t base_height, int divisor,
+			float ratio)
 {
 	gs_effect_t *effect_up = data->effect;
-	// Swap renderers
-	gs_texrender_t *tmp = data->render;
-	data->render = data->render2;
-	data->render2 = tmp;
-
-	data->render = create_or_reset_texrender(data->render);
 
 	uint32_t start_w = gs_texture_get_width(input_texture);
 	uint32_t start_h = gs_texture_get_height(input_texture);
 
-	uint32_t w = data->width / divisor;
-	uint32_t h = data->height / divisor;
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect_up, "image");
-	gs_effect_set_texture(image, input_texture);
+	uint32_t w = base_width / divisor;
+	uint32_t h = base_height / divisor;
+	effect_param_set_texture(&data->param_kawase_image, input_texture);
 
-	gs_eparam_t *texel_step =
-		gs_effect_get_param_by_name(effect_up, "texel_step");
 	struct vec2 texel_step_size;
 	texel_step_size.x = ratio / (float)start_w;
 	texel_step_size.y = ratio / (float)start_h;
-	gs_effect_set_vec2(texel_step, &texel_step_size);
+	effect_param_set_vec2(&data->param_kawase_texel_step,
+			      &texel_step_size);
 
-	if (gs_texrender_begin(data->render, w, h)) {
+	if (gs_texrender_begin(target, w, h)) {
 		gs_ortho(0.0f, (float)w, 0.0f, (float)h, -100.0f, 100.0f);
 		while (gs_effect_loop(effect_up, "Draw"))
 			gs_draw_sprite(input_texture, 0, w, h);
-		gs_texrender_end(data->render);
+		gs_texrender_end(target);
 	}
-	return gs_texrender_get_texture(data->render);
+	return gs_texrender_get_texture(target);
 }
 
-gs_texture_t *mix_textures(composite_blur_filter_data_t *data,
-			   gs_texture_t *base, gs_texture_t *residual,
-			   float ratio)
+/*
+ *  Upsamples input_texture by one level and blends the result with
+ *  base, the previous level at the destination size, in the same pass.
+ *  Both inputs are pyramid levels, so target may be any up sample
+ *  target.
+ */
+static gs_texture_t *up_sample_mix(composite_blur_filter_data_t *data,
+				   gs_texture_t *input_texture,
+				   gs_texture_t *base, gs_texrender_t *target,
+				   uint32_t base_width, uint32_t base_height,
+				   int divisor, float mix_ratio)
 {
-	gs_effect_t *effect = data->mix_effect;
-	// Swap renderers
-	gs_texrender_t *tmp = data->render;
-	data->render = data->render2;
-	data->render2 = tmp;
-
-	data->render = create_or_reset_texrender(data->render);
-
-	uint32_t w = gs_texture_get_width(base);
-	uint32_t h = gs_texture_get_height(base);
+	gs_effect_t *effect_up = data->effect;
 
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
-	gs_effect_set_texture(image, base);
+	uint32_t start_w = gs_texture_get_width(input_texture);
+	uint32_t start_h = gs_texture_get_height(input_texture);
 
-	gs_eparam_t *image2 = gs_effect_get_param_by_name(effect, "image2");
-	gs_effect_set_texture(image2, residual);
+	uint32_t w = base_width / divisor;
+	uint32_t h = base_height / divisor;
+	effect_param_set_texture(&data->param_kawase_image, input_texture);
+	effect_param_set_texture(&data->param_kawase_base_image, base);
+	effect_param_set_float(&data->param_kawase_mix_ratio, mix_ratio);
 
-	gs_eparam_t *ratio_param = gs_effect_get_param_by_name(effect, "ratio");
-	gs_effect_set_float(ratio_param, ratio);
+	struct vec2 texel_step_size;
+	texel_step_size.x = 1.0f / (float)start_w;
+	texel_step_size.y = 1.0f / (float)start_h;
+	effect_param_set_vec2(&data->param_kawase_texel_step,
+			      &texel_step_size);
 
-	if (gs_texrender_begin(data->render, w, h)) {
+	if (gs_texrender_begin(target, w, h)) {
 		gs_ortho(0.0f, (float)w, 0.0f, (float)h, -100.0f, 100.0f);
-		while (gs_effect_loop(effect, "Draw"))
-			gs_draw_sprite(base, 0, w, h);
-		gs_texrender_end(data->render);
+		while (gs_effect_loop(effect_up, "DrawMix"))
+			gs_draw_sprite(input_texture, 0, w, h);
+		gs_texrender_end(target);
 	}
-	return gs_texrender_get_texture(data->render);
+	return gs_texrender_get_texture(target);
 }
 
 static void dual_kawase_blur(composite_blur_filter_data_t *data)
@@ -164,9 +145,15 @@ static void dual_kawase_blur(composite_blur_filter_data_t *data)
 				obs_obj_get_data(filter_to);
 			if (data_to &&
 			    data_to->blur_algorithm == data->blur_algorithm) {
+				// data_to may run at a different
+				// processing scale.
+				const float passes_to =
+					data_to->kawase_passes *
+					(float)data_to->processing_scale /
+					(float)data->processing_scale;
 				kawase_passes =
 					data->kawase_passes * (1.0f - f) +
-					data_to->kawase_passes * f;
+					passes_to * f;
 			} else if (f > 0.5f) {
 				kawase_passes *= 1.0f - (f - 0.5f) * 2.0f;
 			} else {
@@ -178,73 +165,99 @@ static void dual_kawase_blur(composite_blur_filter_data_t *data)
 	}
 
 	if (kawase_passes <= 0.01f) {
-		data->output_texrender =
-			create_or_reset_texrender(data->output_texrender);
+		data->output_texrender = create_or_reset_texrender_format(
+			data->output_texrender,
+			gs_texture_get_color_format(texture));
 		texrender_set_texture(texture, data->output_texrender);
 		return;
 	}
-	gs_effect_t *effect_up = data->effect;
-	gs_effect_t *effect_down = data->effect_2;
-	gs_texrender_t *base_render = NULL;
 
-	if (!effect_down || !effect_up || !texture) {
+	if (!data->kawase_down.effect || !data->effect || !texture) {
 		return;
 	}
 
 	texture = blend_composite(texture, data);
-	set_blending_parameters();
-	// TODO: Should we convert Kawase to be 1 based instead of 2.
-	int last_pass = 0;
-	// Down Sampling Loop
-	for (int i = 2; i <= kawase_passes; i *= 2) {
-		texture = down_sample(data, texture, i, 1.0);
-		last_pass = i;
+	data->output_texrender = create_or_reset_texrender_format(
+		data->output_texrender, gs_texture_get_color_format(texture));
+	dual_kawase_render(data, texture, kawase_passes,
+			   data->output_texrender);
+}
+
+/*
+ *  Blurs texture by kawase_passes into output. Intermediate up sample
+ *  steps ping-pong between render and render2, so output must be
+ *  neither of them.
+ */
+void dual_kawase_render(composite_blur_filter_data_t *data,
+			gs_texture_t *texture, float kawase_passes,
+			gs_texrender_t *output)
+{
+	gs_effect_t *effect_up = data->effect;
+	pyramid_effect_t *effect_down = &data->kawase_down;
+
+	if (!effect_down->effect || !effect_up || !texture || !output) {
+		return;
 	}
 
-	if (last_pass == 0) {
-		gs_texrender_t *tmp = data->render;
-		data->render = data->input_texrender;
-		data->input_texrender = tmp;
+	// Up sample targets take the input format, so only 8 bit chains
+	// are dithered (not e.g. the GS_RG16F vector blur gradient).
+	const enum gs_color_format format =
+		gs_texture_get_color_format(texture);
+	set_dither_strength(&data->param_dither_strength, format);
+
+	// Level sizes and formats come from the input texture rather than
+	// data->width/GS_RGBA so reduced resolution or two channel inputs
+	// (e.g. vector blur gradients) can be smoothed as well.
+	const uint32_t base_width = gs_texture_get_width(texture);
+	const uint32_t base_height = gs_texture_get_height(texture);
+
+	set_blending_parameters();
+	// The down sample chain comes from the shared pyramid, and is
+	// only rendered once per input per frame.
+	blur_pyramid_t *pyramid =
+		pyramid_acquire(data->pyramids, effect_down, texture, "Draw");
+	// TODO: Should we convert Kawase to be 1 based instead of 2.
+	int last_pass = 1;
+	int level = 0;
+	while (level < PYRAMID_MAX_LEVELS - 1 &&
+	       (float)(last_pass * 2) <= kawase_passes) {
+		last_pass *= 2;
+		level++;
 	}
+	texture = pyramid_get_level(pyramid, level);
 
-	float residual = last_pass > 0 ? kawase_passes - (float)last_pass
-				       : kawase_passes;
-	last_pass = last_pass > 0 ? last_pass : 1;
+	// Below two passes the base is the unblurred input, so ramp the
+	// ratio over [0, 2) to avoid overshooting past the first level.
+	// The final step renders straight into output.
+	float residual = level > 0 ? kawase_passes - (float)last_pass
+				   : kawase_passes;
 	if (residual > 0.0f) {
 		int next_pass = last_pass * 2;
-		float ratio = residual / (float)(next_pass - last_pass);
-
-		// Downsample one more step
-		texture = down_sample(data, texture, next_pass, 1.0);
-		// Extract renderer from end of down sampling loop
-		base_render = data->render2;
-		data->render2 = NULL;
-		// Upsample one more step
-		texture = up_sample(data, texture, last_pass, 1.0);
-		gs_texture_t *base = gs_texrender_get_texture(base_render);
-		// Mix the end of the downsample loop with additional step.
-		// Use the residual ratio for mixing.
-		texture = mix_textures(data, base, texture, ratio);
+		float ratio = level > 0
+				      ? residual / (float)(next_pass - last_pass)
+				      : residual / (float)next_pass;
+
+		// Upsample one more level and blend it with the end of the
+		// down sample chain, weighted by the residual ratio.
+		gs_texture_t *base = texture;
+		gs_texrender_t *target =
+			last_pass > 1 ? up_sample_target(data, format) : output;
+		texture = pyramid_get_level(pyramid, level + 1);
+		texture = up_sample_mix(data, texture, base, target, base_width,
+					base_height, last_pass, ratio);
 	}
 	// Upsample Loop
 	for (int i = last_pass / 2; i >= 1; i /= 2) {
-		texture = up_sample(data, texture, i, 1.0);
+		gs_texrender_t *target =
+			i > 1 ? up_sample_target(data, format) : output;
+		texture = up_sample(data, texture, target, base_width,
+				    base_height, i, 1.0);
 	}
 
 	gs_blend_state_pop();
-
-	// Copy resulting frame to output-> texrenderer
-	gs_texrender_t *tmp = data->render;
-	data->render = data->output_texrender;
-	data->output_texrender = tmp;
-	// Destroy base_render if used (if there was a residual)
-	if (base_render) {
-		gs_texrender_destroy(base_render);
-	}
 }
 
-static void
-load_dual_kawase_down_sample_effect(composite_blur_filter_data_t *filter)
+void load_dual_kawase_down_sample_effect(composite_blur_filter_data_t *filter)
 {
 	if (filter->effect_2 != NULL) {
 		obs_enter_graphics();
@@ -270,6 +283,7 @@ load_dual_kawase_down_sample_effect(composite_blur_filter_data_t *filter)
 			}
 		}
 	}
+	pyramid_effect_bind(&filter->kawase_down, filter->effect_2);
 }
 
 static void
@@ -284,6 +298,11 @@ load_dual_kawase_up_sample_effect(composite_blur_filter_data_t *filter)
 
 	const char *effect_file_path = "/shaders/dual_kawase_up_sample.effect";
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_kawase_image, NULL);
+	effect_param_init(&filter->param_kawase_base_image, NULL);
+	effect_param_init(&filter->param_kawase_mix_ratio, NULL);
+	effect_param_init(&filter->param_kawase_texel_step, NULL);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count = gs_effect_get_num_params(filter->effect);
 		for (size_t effect_index = 0; effect_index < effect_count;
@@ -294,6 +313,23 @@ load_dual_kawase_up_sample_effect(composite_blur_filter_data_t *filter)
 			gs_effect_get_param_info(param, &info);
 			if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
+			} else if (strcmp(info.name, "image") == 0) {
+				effect_param_init(&filter->param_kawase_image,
+						  param);
+			} else if (strcmp(info.name, "base_image") == 0) {
+				effect_param_init(
+					&filter->param_kawase_base_image,
+					param);
+			} else if (strcmp(info.name, "mix_ratio") == 0) {
+				effect_param_init(
+					&filter->param_kawase_mix_ratio, param);
+			} else if (strcmp(info.name, "texel_step") == 0) {
+				effect_param_init(
+					&filter->param_kawase_texel_step,
+					param);
+			} else if (strcmp(info.name, "dither_strength") == 0) {
+				effect_param_init(
+					&filter->param_dither_strength, param);
 			}
 		}
 	}
@@ -4,6 +4,7 @@
 #include <obs-module.h>
 #include "../obs-utils.h"
 #include "../obs-composite-blur-filter.h"
+#include "pyramid.h"
 
 extern void set_dual_kawase_blur_types(obs_properties_t *props);
 extern void dual_kawase_setup_callbacks(composite_blur_filter_data_t *data);
@@ -11,10 +12,17 @@ extern void render_video_dual_kawase(composite_blur_filter_data_t *data);
 extern void render_video_dual_kawase_io(composite_blur_filter_data_t *data, gs_texrender_t *input, gs_texrender_t *output);
 extern void load_effect_dual_kawase(composite_blur_filter_data_t *filter);
 static void dual_kawase_blur(composite_blur_filter_data_t *data);
-static void
+extern void dual_kawase_render(composite_blur_filter_data_t *data,
+			       gs_texture_t *texture, float kawase_passes,
+			       gs_texrender_t *output);
+extern void
 load_dual_kawase_down_sample_effect(composite_blur_filter_data_t *filter);
 static void
 load_dual_kawase_up_sample_effect(composite_blur_filter_data_t *filter);
-static gs_texture_t *mix_textures(composite_blur_filter_data_t *data,
-				  gs_texture_t *base, gs_texture_t *residual,
-				  float ratio);
+static gs_texrender_t *up_sample_target(composite_blur_filter_data_t *data,
+					enum gs_color_format format);
+static gs_texture_t *up_sample_mix(composite_blur_filter_data_t *data,
+				   gs_texture_t *input_texture,
+				   gs_texture_t *base, gs_texrender_t *target,
+				   uint32_t base_width, uint32_t base_height,
+				   int divisor, float mix_ratio);
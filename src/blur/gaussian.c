@@ -26,19 +26,35 @@ void gaussian_setup_callbacks(composite_blur_filter_data_t *data)
 
 void update_gaussian(composite_blur_filter_data_t *data)
 {
-	if (data->radius != data->radius_last) {
-		data->radius_last = data->radius;
-		sample_kernel(data->radius, data);
+	// Vector blur samples its kernel from the blur amount, every other
+	// type from the radius. Building one resets the key of the other,
+	// so switching types always rebuilds the kernel.
+	if (data->blur_type == TYPE_VECTOR) {
+		if (data->vector_blur_amount != data->last_vector_blur_amount) {
+			data->last_vector_blur_amount = data->vector_blur_amount;
+			data->radius_last = -1.0f;
+			float blur_radius = fabsf(data->vector_blur_amount);
+			sample_kernel(blur_radius, data);
+		}
+		return;
 	}
-	if (data->vector_blur_amount != data->last_vector_blur_amount) {
-		data->last_vector_blur_amount = data->vector_blur_amount;
-		float blur_radius = fabsf(data->vector_blur_amount);
-		sample_kernel(blur_radius, data);
+	const int log_step_passes = gaussian_log_step_passes(data);
+	if (data->radius != data->radius_last ||
+	    log_step_passes != data->log_step_passes) {
+		data->radius_last = data->radius;
+		data->log_step_passes = log_step_passes;
+		data->last_vector_blur_amount = -999999.0f;
+		// The final pass of a log-step blur steps 2^passes texels
+		// per tap, so its kernel only needs to span radius/2^passes.
+		sample_kernel(data->radius / (float)(1 << log_step_passes),
+			      data);
 	}
 }
 
 void render_video_gaussian(composite_blur_filter_data_t *data)
 {
+	set_dither_strength(&data->param_dither_strength,
+			    get_pipeline_format());
 	switch (data->blur_type) {
 	case TYPE_AREA:
 		gaussian_area_blur(data);
@@ -66,12 +82,14 @@ void load_effect_gaussian(composite_blur_filter_data_t *filter)
 		break;
 	case TYPE_DIRECTIONAL:
 		load_1d_gaussian_effect(filter);
+		load_log_step_effect(filter);
 		break;
 	case TYPE_ZOOM:
 		load_radial_gaussian_effect(filter);
 		break;
 	case TYPE_MOTION:
 		load_motion_gaussian_effect(filter);
+		load_log_step_effect(filter);
 		break;
 	case TYPE_VECTOR:
 		load_vector_gaussian_effect(filter);
@@ -92,9 +110,66 @@ extern bool vector_channel_modified(void* data, obs_properties_t* props,
 	composite_blur_filter_data_t* filter = data;
 	filter->vector_blur_channel = channel;
 	load_gradient_effect(filter);
+	filter->vb_gradient_dirty = true;
 	return false;
 }
 
+/*
+ *  Switches the vector blur source, moving the "update" signal
+ *  connection used to invalidate the cached gradient. Passing NULL
+ *  releases the current source.
+ */
+void vector_blur_set_source(composite_blur_filter_data_t *filter,
+			    obs_source_t *source)
+{
+	obs_source_t *current =
+		filter->vector_blur_source
+			? obs_weak_source_get_source(filter->vector_blur_source)
+			: NULL;
+	if (current == source) {
+		obs_source_release(current);
+		return;
+	}
+	if (current) {
+		signal_handler_t *sh = obs_source_get_signal_handler(current);
+		signal_handler_disconnect(sh, "update",
+					  vector_blur_source_updated, filter);
+		obs_source_release(current);
+	}
+	if (filter->vector_blur_source) {
+		obs_weak_source_release(filter->vector_blur_source);
+		filter->vector_blur_source = NULL;
+	}
+	if (source) {
+		filter->vector_blur_source = obs_source_get_weak_source(source);
+		signal_handler_t *sh = obs_source_get_signal_handler(source);
+		signal_handler_connect(sh, "update", vector_blur_source_updated,
+				       filter);
+	}
+	filter->vb_gradient_dirty = true;
+}
+
+static void vector_blur_source_updated(void *data, calldata_t *call_data)
+{
+	UNUSED_PARAMETER(call_data);
+	composite_blur_filter_data_t *filter = data;
+	filter->vb_gradient_dirty = true;
+}
+
+/*
+ *  Direct3D 11 only. Sends the used taps of the kernel weights and
+ *  offsets, and nothing when the effect already holds this kernel.
+ */
+static void set_kernel_arrays(composite_blur_filter_data_t *data)
+{
+	effect_param_set_array(&data->param_weight, data->kernel.array,
+			       data->kernel.num, data->kernel_size,
+			       data->kernel_version);
+	effect_param_set_array(&data->param_offset, data->offset.array,
+			       data->offset.num, data->kernel_size,
+			       data->kernel_version);
+}
+
 /*
  *  Performs an area blur using the gaussian kernel. Blur is
  *  equal in both x and y directions.
@@ -125,16 +200,7 @@ static void gaussian_area_blur(composite_blur_filter_data_t *data)
 
 	switch (data->device_type) {
 	case GS_DEVICE_DIRECT3D_11:
-		if (data->param_weight) {
-			gs_effect_set_val(data->param_weight,
-					  data->kernel.array,
-					  data->kernel.num * sizeof(float));
-		}
-		if (data->param_offset) {
-			gs_effect_set_val(data->param_offset,
-					  data->offset.array,
-					  data->offset.num * sizeof(float));
-		}
+		set_kernel_arrays(data);
 		break;
 	case GS_DEVICE_OPENGL:
 		if (data->param_kernel_texture) {
@@ -158,10 +224,12 @@ static void gaussian_area_blur(composite_blur_filter_data_t *data)
 	set_blending_parameters();
 
 	if (gs_texrender_begin(data->render2, data->width, data->height)) {
+		stencil_pass_begin(data);
 		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
 			 -100.0f, 100.0f);
 		while (gs_effect_loop(effect, "Draw"))
 			gs_draw_sprite(texture, 0, data->width, data->height);
+		stencil_pass_end(data);
 		gs_texrender_end(data->render2);
 	}
 
@@ -189,10 +257,12 @@ static void gaussian_area_blur(composite_blur_filter_data_t *data)
 
 	if (gs_texrender_begin(data->output_texrender, data->width,
 			       data->height)) {
+		stencil_pass_begin(data);
 		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
 			 -100.0f, 100.0f);
 		while (gs_effect_loop(effect, "Draw"))
 			gs_draw_sprite(texture, 0, data->width, data->height);
+		stencil_pass_end(data);
 		gs_texrender_end(data->output_texrender);
 	}
 
@@ -219,6 +289,15 @@ static void gaussian_directional_blur(composite_blur_filter_data_t *data)
 	}
 
 	texture = blend_composite(texture, data);
+
+	float rads = -data->angle * (M_PI / 180.0f);
+	struct vec2 direction;
+	direction.x = (float)cos(rads) / data->width;
+	direction.y = (float)sin(rads) / data->height;
+
+	texture = gaussian_log_step_accumulate(data, texture, &direction,
+					       "DrawSymmetric");
+	const float step_scale = (float)(1 << data->log_step_passes);
 	//gs_texture_t *background_texture = NULL;
 	//if (data->background) {
 	//	get_background(data);
@@ -236,16 +315,7 @@ static void gaussian_directional_blur(composite_blur_filter_data_t *data)
 
 	switch (data->device_type) {
 	case GS_DEVICE_DIRECT3D_11:
-		if (data->param_weight) {
-			gs_effect_set_val(data->param_weight,
-					  data->kernel.array,
-					  data->kernel.num * sizeof(float));
-		}
-		if (data->param_offset) {
-			gs_effect_set_val(data->param_offset,
-					  data->offset.array,
-					  data->offset.num * sizeof(float));
-		}
+		set_kernel_arrays(data);
 		break;
 	case GS_DEVICE_OPENGL:
 		if (data->param_kernel_texture) {
@@ -261,9 +331,8 @@ static void gaussian_directional_blur(composite_blur_filter_data_t *data)
 	}
 
 	struct vec2 texel_step;
-	float rads = -data->angle * (M_PI / 180.0f);
-	texel_step.x = (float)cos(rads) / data->width;
-	texel_step.y = (float)sin(rads) / data->height;
+	texel_step.x = direction.x * step_scale;
+	texel_step.y = direction.y * step_scale;
 	if (data->param_texel_step) {
 		gs_effect_set_vec2(data->param_texel_step, &texel_step);
 	}
@@ -278,10 +347,12 @@ static void gaussian_directional_blur(composite_blur_filter_data_t *data)
 
 	if (gs_texrender_begin(data->output_texrender, data->width,
 			       data->height)) {
+		stencil_pass_begin(data);
 		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
 			 -100.0f, 100.0f);
 		while (gs_effect_loop(effect, technique))
 			gs_draw_sprite(texture, 0, data->width, data->height);
+		stencil_pass_end(data);
 		gs_texrender_end(data->output_texrender);
 	}
 
@@ -309,22 +380,22 @@ static void gaussian_motion_blur(composite_blur_filter_data_t *data)
 
 	texture = blend_composite(texture, data);
 
+	float rads = -data->angle * (M_PI / 180.0f);
+	struct vec2 direction;
+	direction.x = (float)cos(rads) / data->width;
+	direction.y = (float)sin(rads) / data->height;
+
+	texture = gaussian_log_step_accumulate(data, texture, &direction,
+					       "DrawForward");
+	const float step_scale = (float)(1 << data->log_step_passes);
+
 	// 1. Single pass- blur only in one direction
 	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
 	gs_effect_set_texture(image, texture);
 
 	switch (data->device_type) {
 	case GS_DEVICE_DIRECT3D_11:
-		if (data->param_weight) {
-			gs_effect_set_val(data->param_weight,
-					  data->kernel.array,
-					  data->kernel.num * sizeof(float));
-		}
-		if (data->param_offset) {
-			gs_effect_set_val(data->param_offset,
-					  data->offset.array,
-					  data->offset.num * sizeof(float));
-		}
+		set_kernel_arrays(data);
 		break;
 	case GS_DEVICE_OPENGL:
 		if (data->param_kernel_texture) {
@@ -340,9 +411,8 @@ static void gaussian_motion_blur(composite_blur_filter_data_t *data)
 	}
 
 	struct vec2 texel_step;
-	float rads = -data->angle * (M_PI / 180.0f);
-	texel_step.x = (float)cos(rads) / data->width;
-	texel_step.y = (float)sin(rads) / data->height;
+	texel_step.x = direction.x * step_scale;
+	texel_step.y = direction.y * step_scale;
 	if (data->param_texel_step) {
 		gs_effect_set_vec2(data->param_texel_step, &texel_step);
 	}
@@ -354,16 +424,104 @@ static void gaussian_motion_blur(composite_blur_filter_data_t *data)
 
 	if (gs_texrender_begin(data->output_texrender, data->width,
 			       data->height)) {
+		stencil_pass_begin(data);
 		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
 			 -100.0f, 100.0f);
 		while (gs_effect_loop(effect, "Draw"))
 			gs_draw_sprite(texture, 0, data->width, data->height);
+		stencil_pass_end(data);
 		gs_texrender_end(data->output_texrender);
 	}
 
 	gs_blend_state_pop();
 }
 
+/*
+ *  Number of recursive-doubling passes used ahead of a directional or
+ *  motion blur. Each pass doubles the length of a box average along
+ *  the blur direction, leaving ~16 texels of kernel support for the
+ *  final gaussian pass. Returns 0 when log-step is disabled or the
+ *  blur is short enough that a plain kernel is cheaper.
+ */
+static int gaussian_log_step_passes(composite_blur_filter_data_t *data)
+{
+	if (!data->log_step || data->blur_algorithm != ALGO_GAUSSIAN ||
+	    (data->blur_type != TYPE_DIRECTIONAL &&
+	     data->blur_type != TYPE_MOTION)) {
+		return 0;
+	}
+	const float support = data->radius * 3.0f / 16.0f;
+	if (support < 2.0f) {
+		return 0;
+	}
+	const int passes = (int)floorf(log2f(support));
+	return passes > MAX_LOG_STEP_PASSES ? MAX_LOG_STEP_PASSES : passes;
+}
+
+/*
+ *  Runs the log-step doubling passes. Pass k averages the previous
+ *  result with a copy shifted by 2^k texels along direction, so after
+ *  K passes every pixel holds a 2^K texel box average at a cost of two
+ *  taps per pass. Centered passes start with a half texel shift, whose
+ *  bilinear taps average two texels, so their box is widened into a
+ *  trapezoid spanning 2^K + 1 texels. The caller then applies the
+ *  gaussian kernel with its step scaled by 2^K, which restores the
+ *  gaussian falloff.
+ */
+static gs_texture_t *
+gaussian_log_step_accumulate(composite_blur_filter_data_t *data,
+			     gs_texture_t *texture,
+			     const struct vec2 *direction,
+			     const char *technique)
+{
+	gs_effect_t *effect = data->effect_2;
+	if (!effect || data->log_step_passes < 1) {
+		return texture;
+	}
+
+	const bool symmetric = strcmp(technique, "DrawSymmetric") == 0;
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+
+	set_blending_parameters();
+
+	for (int k = 0; k < data->log_step_passes; k++) {
+		// Centered passes shift by +-2^(k-1) so the box stays
+		// centered, trailing passes shift by 2^k.
+		const float shift = symmetric ? (float)(1 << k) * 0.5f
+					      : (float)(1 << k);
+		struct vec2 texel_step;
+		texel_step.x = direction->x * shift;
+		texel_step.y = direction->y * shift;
+
+		gs_effect_set_texture(image, texture);
+		if (data->param_log_step_texel_step) {
+			gs_effect_set_vec2(data->param_log_step_texel_step,
+					   &texel_step);
+		}
+
+		data->render = create_or_reset_texrender(data->render);
+		if (gs_texrender_begin(data->render, data->width,
+				       data->height)) {
+			stencil_pass_begin(data);
+			gs_ortho(0.0f, (float)data->width, 0.0f,
+				 (float)data->height, -100.0f, 100.0f);
+			while (gs_effect_loop(effect, technique))
+				gs_draw_sprite(texture, 0, data->width,
+					       data->height);
+			stencil_pass_end(data);
+			gs_texrender_end(data->render);
+		}
+		texture = gs_texrender_get_texture(data->render);
+
+		gs_texrender_t *tmp = data->render;
+		data->render = data->render2;
+		data->render2 = tmp;
+	}
+
+	gs_blend_state_pop();
+	return texture;
+}
+
 /*
  *  Performs a zoom blur using the gaussian kernel. Blur for a pixel
  *  is performed in direction of zoom center point.
@@ -392,16 +550,7 @@ static void gaussian_zoom_blur(composite_blur_filter_data_t *data)
 
 	switch (data->device_type) {
 	case GS_DEVICE_DIRECT3D_11:
-		if (data->param_weight) {
-			gs_effect_set_val(data->param_weight,
-					  data->kernel.array,
-					  data->kernel.num * sizeof(float));
-		}
-		if (data->param_offset) {
-			gs_effect_set_val(data->param_offset,
-					  data->offset.array,
-					  data->offset.num * sizeof(float));
-		}
+		set_kernel_arrays(data);
 		break;
 	case GS_DEVICE_OPENGL:
 		if (data->param_kernel_texture) {
@@ -458,29 +607,69 @@ static void gaussian_zoom_blur(composite_blur_filter_data_t *data)
  */
 static void gaussian_vector_blur(composite_blur_filter_data_t* data)
 {
-	gaussian_vector_gradient(data);
-
-	//gs_texrender_t* tmp = data->output_texrender;
-	//data->output_texrender = data->vb_gradient;
-	//data->vb_gradient = tmp;
-	//return;
+	// The input itself changes every frame, as do non-static sources.
+	// A static source only needs a new gradient when its settings,
+	// size or the vector blur settings changed.
+	const uint32_t scale = (uint32_t)data->vector_gradient_scale;
+	const uint32_t gradient_width = (data->width + scale - 1) / scale;
+	const uint32_t gradient_height = (data->height + scale - 1) / scale;
+	if (gradient_width != data->vb_gradient_width ||
+	    gradient_height != data->vb_gradient_height) {
+		data->vb_gradient_width = gradient_width;
+		data->vb_gradient_height = gradient_height;
+		data->vb_gradient_dirty = true;
+	}
+	if (data->vector_blur_source && data->vector_source_static) {
+		obs_source_t *source =
+			obs_weak_source_get_source(data->vector_blur_source);
+		if (source) {
+			if (obs_source_get_width(source) !=
+				    data->vb_source_width ||
+			    obs_source_get_height(source) !=
+				    data->vb_source_height) {
+				data->vb_gradient_dirty = true;
+			}
+			obs_source_release(source);
+		}
+	}
+	const bool cached = data->vector_blur_source &&
+			    data->vector_source_static &&
+			    !data->vb_gradient_dirty &&
+			    data->vb_smoothed_gradient;
 
-	gaussian_vector_smooth_gradient(data);
-	//gs_texrender_t* tmp = data->output_texrender;
-	//data->output_texrender = data->vb_smoothed_gradient;
-	//data->vb_smoothed_gradient = tmp;
-	//return;
+	if (!data->vb_smoothed_gradient) {
+		data->vb_smoothed_gradient =
+			gs_texrender_create(GS_RG16F, GS_ZS_NONE);
+	}
+
+	// The smoothed gradient persists between frames. While it is
+	// cached, both passes are culled and the transient gradient
+	// target goes back to the pool.
+	render_graph_t *graph = &data->graph;
+	render_graph_begin(graph, &data->graph_pool);
+	const int gradient = render_graph_create(graph, gradient_width,
+						 gradient_height, GS_RG16F);
+	const int smoothed =
+		render_graph_import(graph, data->vb_smoothed_gradient, cached);
+	render_graph_add_pass(graph, "vector gradient", NULL, 0, gradient,
+			      gaussian_vector_gradient, data);
+	render_graph_add_pass(graph, "vector gradient smoothing", &gradient, 1,
+			      smoothed, gaussian_vector_smooth_gradient, data);
+	render_graph_mark_sink(graph, smoothed);
+	render_graph_execute(graph);
 
 	gaussian_vector_apply_blur(data);
 }
 
-static void gaussian_vector_gradient(composite_blur_filter_data_t* data)
+static void gaussian_vector_gradient(void *param,
+				     gs_texrender_t *const *inputs,
+				     gs_texrender_t *output)
 {
+	UNUSED_PARAMETER(inputs);
+	composite_blur_filter_data_t *data = param;
 	gs_effect_t* effect = data->gradient_effect;
 	gs_texture_t* texture = NULL;
 
-	gs_texrender_t* source_render = NULL;
-
 	if (data->vector_blur_source) {
 		obs_source_t* source = obs_weak_source_get_source(
 			data->vector_blur_source);
@@ -500,14 +689,17 @@ static void gaussian_vector_gradient(composite_blur_filter_data_t* data)
 		const enum gs_color_format format =
 			gs_get_format_from_space(space);
 
-		// Set up a tex renderer for source
-		source_render = gs_texrender_create(format, GS_ZS_NONE);
+		// Render source into the persistent vector source target
+		data->vb_source_render = create_or_reset_texrender_format(
+			data->vb_source_render, format);
 		uint32_t base_width = obs_source_get_width(source);
 		uint32_t base_height = obs_source_get_height(source);
+		data->vb_source_width = base_width;
+		data->vb_source_height = base_height;
 		gs_blend_state_push();
 		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
 		if (gs_texrender_begin_with_color_space(
-			source_render, base_width, base_height, space)) {
+			data->vb_source_render, base_width, base_height, space)) {
 			const float w = (float)base_width;
 			const float h = (float)base_height;
 			struct vec4 clear_color;
@@ -515,11 +707,11 @@ static void gaussian_vector_gradient(composite_blur_filter_data_t* data)
 			gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
 			gs_ortho(0.0f, w, 0.0f, h, -100.0f, 100.0f);
 			obs_source_video_render(source);
-			gs_texrender_end(source_render);
+			gs_texrender_end(data->vb_source_render);
 		}
 		gs_blend_state_pop();
 		obs_source_release(source);
-		texture = gs_texrender_get_texture(source_render);
+		texture = gs_texrender_get_texture(data->vb_source_render);
 	} else {
 		texture = gs_texrender_get_texture(data->input_texrender);
 	}
@@ -552,47 +744,44 @@ static void gaussian_vector_gradient(composite_blur_filter_data_t* data)
 		gs_effect_set_vec2(data->param_gradient_uv_size, &uv_size);
 	}
 
-	set_blending_parameters();
+	// The gradient field is heavily smoothed afterwards, so it can be
+	// computed at a fraction of the source resolution.
+	const uint32_t scale = (uint32_t)data->vector_gradient_scale;
+	const uint32_t width = data->vb_gradient_width;
+	const uint32_t height = data->vb_gradient_height;
+	if (data->param_gradient_scale) {
+		gs_effect_set_float(data->param_gradient_scale, (float)scale);
+	}
 
-	data->vb_gradient = create_or_reset_texrender(data->vb_gradient);
+	set_blending_parameters();
 
-	if (gs_texrender_begin(data->vb_gradient, data->width,
-		data->height)) {
-		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
-			-100.0f, 100.0f);
+	// Signed (x, y) gradient in the GS_RG16F target declared by
+	// gaussian_vector_blur, half the size of RGBA8 and no need to split
+	// each axis into positive and negative channels.
+	if (gs_texrender_begin(output, width, height)) {
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f,
+			 100.0f);
 		while (gs_effect_loop(effect, technique))
-			gs_draw_sprite(texture, 0, data->width, data->height);
-		gs_texrender_end(data->vb_gradient);
-	}
-
-	if (source_render) {
-		gs_texrender_destroy(source_render);
+			gs_draw_sprite(texture, 0, width, height);
+		gs_texrender_end(output);
 	}
 
 	gs_blend_state_pop();
+	data->vb_gradient_dirty = false;
 }
 
-static void gaussian_vector_smooth_gradient(composite_blur_filter_data_t* data)
+static void gaussian_vector_smooth_gradient(void *param,
+					    gs_texrender_t *const *inputs,
+					    gs_texrender_t *output)
 {
-	if (!data->vb_smoothed_gradient) {
-		data->vb_smoothed_gradient = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
-	}
-
-	data->kawase_passes = data->vector_blur_smoothing + 1.0f;
-
-	gs_texrender_t* tmp = data->input_texrender;
-	data->input_texrender = data->vb_gradient;
-	data->vb_gradient = tmp;
-
-	render_video_dual_kawase(data);
-
-	tmp = data->input_texrender;
-	data->input_texrender = data->vb_gradient;
-	data->vb_gradient = tmp;
-
-	tmp = data->output_texrender;
-	data->output_texrender = data->vb_smoothed_gradient;
-	data->vb_smoothed_gradient = tmp;
+	composite_blur_filter_data_t *data = param;
+
+	// Smoothing is specified in source pixels, but runs on the reduced
+	// resolution gradient field.
+	const float passes = (data->vector_blur_smoothing + 1.0f) /
+			     (float)data->vector_gradient_scale;
+	dual_kawase_render(data, gs_texrender_get_texture(inputs[0]), passes,
+			   output);
 }
 
 static void gaussian_vector_apply_blur(composite_blur_filter_data_t* data)
@@ -619,16 +808,7 @@ static void gaussian_vector_apply_blur(composite_blur_filter_data_t* data)
 
 	switch (data->device_type) {
 	case GS_DEVICE_DIRECT3D_11:
-		if (data->param_weight) {
-			gs_effect_set_val(data->param_weight,
-				data->kernel.array,
-				data->kernel.num * sizeof(float));
-		}
-		if (data->param_offset) {
-			gs_effect_set_val(data->param_offset,
-				data->offset.array,
-				data->offset.num * sizeof(float));
-		}
+		set_kernel_arrays(data);
 		break;
 	case GS_DEVICE_OPENGL:
 		if (data->param_kernel_texture) {
@@ -691,6 +871,7 @@ static void load_1d_gaussian_effect(composite_blur_filter_data_t *filter)
 			: "/shaders/gaussian_1d_texture.effect";
 
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count = gs_effect_get_num_params(filter->effect);
 		for (size_t effect_index = 0; effect_index < effect_count;
@@ -704,13 +885,18 @@ static void load_1d_gaussian_effect(composite_blur_filter_data_t *filter)
 			} else if (strcmp(info.name, "texel_step") == 0) {
 				filter->param_texel_step = param;
 			} else if (strcmp(info.name, "offset") == 0) {
-				filter->param_offset = param;
+				effect_param_init(&filter->param_offset,
+						  param);
 			} else if (strcmp(info.name, "weight") == 0) {
-				filter->param_weight = param;
+				effect_param_init(&filter->param_weight,
+						  param);
 			} else if (strcmp(info.name, "kernel_size") == 0) {
 				filter->param_kernel_size = param;
 			} else if (strcmp(info.name, "kernel_texture") == 0) {
 				filter->param_kernel_texture = param;
+			} else if (strcmp(info.name, "dither_strength") == 0) {
+				effect_param_init(
+					&filter->param_dither_strength, param);
 			}
 		}
 	}
@@ -732,6 +918,7 @@ static void load_motion_gaussian_effect(composite_blur_filter_data_t *filter)
 			: "/shaders/gaussian_motion_texture.effect";
 
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count = gs_effect_get_num_params(filter->effect);
 		for (size_t effect_index = 0; effect_index < effect_count;
@@ -745,9 +932,11 @@ static void load_motion_gaussian_effect(composite_blur_filter_data_t *filter)
 			} else if (strcmp(info.name, "texel_step") == 0) {
 				filter->param_texel_step = param;
 			} else if (strcmp(info.name, "offset") == 0) {
-				filter->param_offset = param;
+				effect_param_init(&filter->param_offset,
+						  param);
 			} else if (strcmp(info.name, "weight") == 0) {
-				filter->param_weight = param;
+				effect_param_init(&filter->param_weight,
+						  param);
 			} else if (strcmp(info.name, "kernel_size") == 0) {
 				filter->param_kernel_size = param;
 			} else if (strcmp(info.name, "kernel_texture") == 0) {
@@ -757,6 +946,34 @@ static void load_motion_gaussian_effect(composite_blur_filter_data_t *filter)
 	}
 }
 
+static void load_log_step_effect(composite_blur_filter_data_t *filter)
+{
+	if (filter->effect_2 != NULL) {
+		obs_enter_graphics();
+		gs_effect_destroy(filter->effect_2);
+		filter->effect_2 = NULL;
+		obs_leave_graphics();
+	}
+
+	filter->effect_2 = load_shader_effect(
+		filter->effect_2, "/shaders/gaussian_log_step.effect");
+	pyramid_effect_bind(&filter->kawase_down, NULL);
+	filter->param_log_step_texel_step = NULL;
+	if (filter->effect_2) {
+		size_t effect_count = gs_effect_get_num_params(filter->effect_2);
+		for (size_t effect_index = 0; effect_index < effect_count;
+		     effect_index++) {
+			gs_eparam_t *param = gs_effect_get_param_by_idx(
+				filter->effect_2, effect_index);
+			struct gs_effect_param_info info;
+			gs_effect_get_param_info(param, &info);
+			if (strcmp(info.name, "texel_step") == 0) {
+				filter->param_log_step_texel_step = param;
+			}
+		}
+	}
+}
+
 static void load_radial_gaussian_effect(composite_blur_filter_data_t *filter)
 {
 	if (filter->effect != NULL) {
@@ -772,6 +989,7 @@ static void load_radial_gaussian_effect(composite_blur_filter_data_t *filter)
 			: "/shaders/gaussian_radial_texture.effect";
 
 	filter->effect = load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count = gs_effect_get_num_params(filter->effect);
 		for (size_t effect_index = 0; effect_index < effect_count;
@@ -783,9 +1001,11 @@ static void load_radial_gaussian_effect(composite_blur_filter_data_t *filter)
 			if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			} else if (strcmp(info.name, "offset") == 0) {
-				filter->param_offset = param;
+				effect_param_init(&filter->param_offset,
+						  param);
 			} else if (strcmp(info.name, "weight") == 0) {
-				filter->param_weight = param;
+				effect_param_init(&filter->param_weight,
+						  param);
 			} else if (strcmp(info.name, "kernel_size") == 0) {
 				filter->param_kernel_size = param;
 			} else if (strcmp(info.name, "kernel_texture") == 0) {
@@ -829,10 +1049,12 @@ static void load_vector_gaussian_effect(composite_blur_filter_data_t* filter)
 				filter->param_gradient_map = param;
 			}
 			else if (strcmp(info.name, "offset") == 0) {
-				filter->param_offset = param;
+				effect_param_init(&filter->param_offset,
+						  param);
 			}
 			else if (strcmp(info.name, "weight") == 0) {
-				filter->param_weight = param;
+				effect_param_init(&filter->param_weight,
+						  param);
 			}
 			else if (strcmp(info.name, "kernel_size") == 0) {
 				filter->param_kernel_size = param;
@@ -917,6 +1139,9 @@ static void load_gradient_effect(composite_blur_filter_data_t* filter)
 			else if (strcmp(info.name, "channel") == 0) {
 				filter->param_gradient_channel = param;
 			}
+			else if (strcmp(info.name, "gradient_scale") == 0) {
+				filter->param_gradient_scale = param;
+			}
 		}
 	}
 }
@@ -1043,6 +1268,7 @@ static void sample_kernel(float radius, composite_blur_filter_data_t *filter)
 
 	da_free(filter->offset);
 	filter->offset = offsets;
+	filter->kernel_version++;
 
 	// Generate the kernel and offsets as a texture for OpenGL systems
 	// where the red value is the kernel weight and the green value
@@ -23,9 +23,12 @@ void render_video_pixelate(composite_blur_filter_data_t *data)
 
 void load_effect_pixelate(composite_blur_filter_data_t *filter)
 {
+	filter->pixelate_cell_map_valid = false;
+	filter->param_pixel_cell_map = NULL;
 	switch (filter->pixelate_type) {
 	case PIXELATE_TYPE_SQUARE:
 		load_pixelate_square_effect(filter);
+		load_pixelate_square_cells_effect(filter);
 		break;
 	case PIXELATE_TYPE_HEXAGONAL:
 		load_pixelate_hexagonal_effect(filter);
@@ -38,6 +41,7 @@ void load_effect_pixelate(composite_blur_filter_data_t *filter)
 		break;
 	case PIXELATE_TYPE_VORONOI:
 		load_pixelate_voronoi_effect(filter);
+		load_pixelate_voronoi_jfa_effect(filter);
 		break;
 	case PIXELATE_TYPE_RHOMBOID:
 		load_pixelate_rhomboid_effect(filter);
@@ -46,7 +50,7 @@ void load_effect_pixelate(composite_blur_filter_data_t *filter)
 		load_pixelate_triakis_effect(filter);
 		break;
 	}
-	load_effect_dual_kawase(filter);
+	load_dual_kawase_down_sample_effect(filter);
 }
 
 static void pixelate_square_blur(composite_blur_filter_data_t *data)
@@ -81,16 +85,14 @@ static void pixelate_square_blur(composite_blur_filter_data_t *data)
 		}
 	}
 
-	data->kawase_passes = data->pixelate_smoothing_pct / 100.0f * radius;
-	render_video_dual_kawase(data);
-	data->pixelate_texrender =
-		create_or_reset_texrender(data->pixelate_texrender);
-
-	gs_texrender_t *tmp = data->pixelate_texrender;
-	data->pixelate_texrender = data->output_texrender;
-	data->output_texrender = tmp;
+	if (data->pixelate_type == PIXELATE_TYPE_SQUARE &&
+	    data->pixelate_cell_average && radius >= MIN_PIXELATE_BLUR_SIZE &&
+	    data->pixelate_cells_effect) {
+		pixelate_cell_average(data, radius);
+		return;
+	}
 
-	gs_texture_t *texture = gs_texrender_get_texture(data->pixelate_texrender);
+	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
 
 	if (!effect || !texture) {
 		return;
@@ -105,9 +107,36 @@ static void pixelate_square_blur(composite_blur_filter_data_t *data)
 
 	texture = blend_composite(texture, data);
 
+	// Smoothing samples the box filtered pyramid at a level of detail
+	// matching the smoothing width, blending the two nearest levels.
+	gs_texture_t *texture_lod = texture;
+	float lod_mix = 0.0f;
+	const float smoothing = data->pixelate_smoothing_pct / 100.0f * radius;
+	if (smoothing > 1.0f && data->kawase_down.effect) {
+		float lod = fminf(log2f(smoothing),
+				  (float)(PYRAMID_MAX_LEVELS - 1));
+		const int level = (int)floorf(lod);
+		lod_mix = lod - (float)level;
+
+		set_blending_parameters();
+		blur_pyramid_t *pyramid = pyramid_acquire(
+			data->pyramids, &data->kawase_down, texture, "DrawBox");
+		texture = pyramid_get_level(pyramid, level);
+		texture_lod = pyramid_get_level(pyramid, level + 1);
+		gs_blend_state_pop();
+	}
+
 	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
 	gs_effect_set_texture(image, texture);
 
+	if (data->param_pixel_image_lod) {
+		gs_effect_set_texture(data->param_pixel_image_lod,
+				      texture_lod);
+	}
+	if (data->param_pixel_lod_mix) {
+		gs_effect_set_float(data->param_pixel_lod_mix, lod_mix);
+	}
+
 	if (data->param_pixel_size) {
 		gs_effect_set_float(data->param_pixel_size, radius);
 	}
@@ -147,6 +176,25 @@ static void pixelate_square_blur(composite_blur_filter_data_t *data)
 		gs_effect_set_float(data->param_pixel_time,
 				    data->time);
 	}
+	if (data->pixelate_type == PIXELATE_TYPE_VORONOI &&
+	    data->param_pixel_seed_map) {
+		gs_effect_set_texture(data->param_pixel_seed_map,
+				      pixelate_voronoi_seed_map(data, radius));
+	}
+
+	// Static tessellations gather through baked cell centers instead
+	// of recomputing the cell geometry for every pixel.
+	const char *technique = "Draw";
+	if (pixelate_type_has_cell_map(data->pixelate_type) &&
+	    data->param_pixel_cell_map) {
+		gs_texture_t *cell_map =
+			pixelate_bake_cell_map(data, effect, radius);
+		if (cell_map) {
+			gs_effect_set_texture(data->param_pixel_cell_map,
+					      cell_map);
+			technique = "DrawFromCellMap";
+		}
+	}
 
 	data->output_texrender =
 		create_or_reset_texrender(data->output_texrender);
@@ -157,7 +205,7 @@ static void pixelate_square_blur(composite_blur_filter_data_t *data)
 			       data->height)) {
 		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
 			 -100.0f, 100.0f);
-		while (gs_effect_loop(effect, "Draw"))
+		while (gs_effect_loop(effect, technique))
 			gs_draw_sprite(texture, 0, data->width, data->height);
 		gs_texrender_end(data->output_texrender);
 	}
@@ -165,6 +213,287 @@ static void pixelate_square_blur(composite_blur_filter_data_t *data)
 	gs_blend_state_pop();
 }
 
+static bool pixelate_type_has_cell_map(int pixelate_type)
+{
+	switch (pixelate_type) {
+	case PIXELATE_TYPE_HEXAGONAL:
+	case PIXELATE_TYPE_CIRCLE:
+	case PIXELATE_TYPE_TRIANGLE:
+	case PIXELATE_TYPE_RHOMBOID:
+	case PIXELATE_TYPE_TRIAKIS:
+		return true;
+	}
+	return false;
+}
+
+/*
+ *  Bakes the center of the containing cell for every pixel with the
+ *  effect's DrawCellMap technique. Expects the tessellation params of
+ *  effect to be set. The map is only rebaked when the frame size,
+ *  pixel size, origin or rotation changed.
+ */
+static gs_texture_t *pixelate_bake_cell_map(composite_blur_filter_data_t *data,
+					    gs_effect_t *effect, float radius)
+{
+	if (data->pixelate_cell_map_valid &&
+	    data->pixelate_cell_map_type == data->pixelate_type &&
+	    data->pixelate_cell_map_width == data->width &&
+	    data->pixelate_cell_map_height == data->height &&
+	    data->pixelate_cell_map_pixel_size == radius &&
+	    data->pixelate_cell_map_origin.x ==
+		    data->pixelate_tessel_center.x &&
+	    data->pixelate_cell_map_origin.y ==
+		    data->pixelate_tessel_center.y &&
+	    data->pixelate_cell_map_cos_theta == data->pixelate_cos_theta &&
+	    data->pixelate_cell_map_sin_theta == data->pixelate_sin_theta) {
+		return gs_texrender_get_texture(data->pixelate_cell_map);
+	}
+
+	// Cell centers are stored as uv, so need 32 bit floats to address
+	// single pixels of large frames, but only two channels. Gaps
+	// between cells are encoded out of range.
+	data->pixelate_cell_map = create_or_reset_texrender_format(
+		data->pixelate_cell_map, GS_RG32F);
+
+	set_blending_parameters();
+
+	if (gs_texrender_begin(data->pixelate_cell_map, data->width,
+			       data->height)) {
+		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
+			 -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "DrawCellMap"))
+			gs_draw_sprite(NULL, 0, data->width, data->height);
+		gs_texrender_end(data->pixelate_cell_map);
+	}
+
+	gs_blend_state_pop();
+
+	data->pixelate_cell_map_valid = true;
+	data->pixelate_cell_map_type = data->pixelate_type;
+	data->pixelate_cell_map_width = data->width;
+	data->pixelate_cell_map_height = data->height;
+	data->pixelate_cell_map_pixel_size = radius;
+	data->pixelate_cell_map_origin = data->pixelate_tessel_center;
+	data->pixelate_cell_map_cos_theta = data->pixelate_cos_theta;
+	data->pixelate_cell_map_sin_theta = data->pixelate_sin_theta;
+
+	return gs_texrender_get_texture(data->pixelate_cell_map);
+}
+
+/*
+ *  Square pixelate using true cell averages. Renders a target with one
+ *  texel per cell, averaging each cell from a box filtered mip level of
+ *  the input, then looks up the containing cell at full resolution.
+ *  Replaces the kawase smoothing pre-pass, and its cost no longer grows
+ *  with the cell size.
+ */
+static void pixelate_cell_average(composite_blur_filter_data_t *data,
+				  float radius)
+{
+	gs_effect_t *effect = data->pixelate_cells_effect;
+	pyramid_effect_t *effect_down = &data->kawase_down;
+	gs_texture_t *texture = gs_texrender_get_texture(data->input_texrender);
+
+	if (!effect || !effect_down->effect || !texture) {
+		return;
+	}
+
+	texture = blend_composite(texture, data);
+
+	// Range of cell indices, in the rotated grid, covering the frame.
+	const float w = (float)data->width;
+	const float h = (float)data->height;
+	const float corners[4][2] = {{0.0f, 0.0f}, {w, 0.0f}, {0.0f, h}, {w, h}};
+	float min_x = INFINITY, min_y = INFINITY;
+	float max_x = -INFINITY, max_y = -INFINITY;
+	for (int i = 0; i < 4; i++) {
+		const float x = corners[i][0] - data->pixelate_tessel_center.x;
+		const float y = corners[i][1] - data->pixelate_tessel_center.y;
+		const float xp = x * data->pixelate_cos_theta -
+				 y * data->pixelate_sin_theta;
+		const float yp = x * data->pixelate_sin_theta +
+				 y * data->pixelate_cos_theta;
+		min_x = fminf(min_x, xp);
+		min_y = fminf(min_y, yp);
+		max_x = fmaxf(max_x, xp);
+		max_y = fmaxf(max_y, yp);
+	}
+	struct vec2 cell_min;
+	cell_min.x = floorf(min_x / radius);
+	cell_min.y = floorf(min_y / radius);
+	const uint32_t cells_x =
+		(uint32_t)(floorf(max_x / radius) - cell_min.x) + 1;
+	const uint32_t cells_y =
+		(uint32_t)(floorf(max_y / radius) - cell_min.y) + 1;
+	struct vec2 cell_count;
+	cell_count.x = (float)cells_x;
+	cell_count.y = (float)cells_y;
+
+	// Mip level with texels no wider than the tap spacing.
+	int level = (int)floorf(log2f(radius / (float)PIXELATE_CELL_TAPS));
+	level = level < 0 ? 0
+			  : (level > PYRAMID_MAX_LEVELS ? PYRAMID_MAX_LEVELS
+							: level);
+
+	set_blending_parameters();
+
+	blur_pyramid_t *pyramid = pyramid_acquire(data->pyramids, effect_down,
+						  texture, "DrawBox");
+	gs_texture_t *level_texture = pyramid_get_level(pyramid, level);
+
+	struct vec2 uv_size;
+	uv_size.x = w;
+	uv_size.y = h;
+
+	effect_param_set_texture(&data->param_cells_image, level_texture);
+	effect_param_set_vec2(&data->param_cells_uv_size, &uv_size);
+	effect_param_set_float(&data->param_cells_pixel_size, radius);
+	effect_param_set_vec2(&data->param_cells_tess_origin,
+			      &data->pixelate_tessel_center);
+	effect_param_set_float(&data->param_cells_cos_theta,
+			       data->pixelate_cos_theta);
+	effect_param_set_float(&data->param_cells_sin_theta,
+			       data->pixelate_sin_theta);
+	effect_param_set_float(&data->param_cells_cos_rtheta,
+			       data->pixelate_cos_rtheta);
+	effect_param_set_float(&data->param_cells_sin_rtheta,
+			       data->pixelate_sin_rtheta);
+	effect_param_set_vec2(&data->param_cells_cell_min, &cell_min);
+	effect_param_set_vec2(&data->param_cells_cell_count, &cell_count);
+
+	// 1. Average every cell into a cells_x by cells_y target.
+	data->pixelate_cells_texrender = create_or_reset_texrender_format(
+		data->pixelate_cells_texrender,
+		gs_texture_get_color_format(texture));
+	if (gs_texrender_begin(data->pixelate_cells_texrender, cells_x,
+			       cells_y)) {
+		gs_ortho(0.0f, (float)cells_x, 0.0f, (float)cells_y, -100.0f,
+			 100.0f);
+		while (gs_effect_loop(effect, "CellAverage"))
+			gs_draw_sprite(level_texture, 0, cells_x, cells_y);
+		gs_texrender_end(data->pixelate_cells_texrender);
+	}
+
+	// 2. Look up the containing cell for each output pixel.
+	gs_texture_t *cells =
+		gs_texrender_get_texture(data->pixelate_cells_texrender);
+	effect_param_set_texture(&data->param_cells_cells, cells);
+
+	data->output_texrender =
+		create_or_reset_texrender(data->output_texrender);
+	if (gs_texrender_begin(data->output_texrender, data->width,
+			       data->height)) {
+		gs_ortho(0.0f, w, 0.0f, h, -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "Draw"))
+			gs_draw_sprite(cells, 0, data->width, data->height);
+		gs_texrender_end(data->output_texrender);
+	}
+
+	gs_blend_state_pop();
+}
+
+/*
+ *  Returns a map of the nearest voronoi seed for every pixel. Seeds are
+ *  splatted into the map and spread with jump flooding, which takes
+ *  log2(cell size) passes. The map is only rebuilt when the frame size,
+ *  pixel size, origin, rotation or time changed.
+ */
+static gs_texture_t *
+pixelate_voronoi_seed_map(composite_blur_filter_data_t *data, float radius)
+{
+	gs_effect_t *effect = data->voronoi_jfa_effect;
+	if (!effect) {
+		return NULL;
+	}
+
+	if (data->voronoi_seed_map_valid &&
+	    data->voronoi_map_width == data->width &&
+	    data->voronoi_map_height == data->height &&
+	    data->voronoi_map_pixel_size == radius &&
+	    data->voronoi_map_time == data->time &&
+	    data->voronoi_map_origin.x == data->pixelate_tessel_center.x &&
+	    data->voronoi_map_origin.y == data->pixelate_tessel_center.y &&
+	    data->voronoi_map_cos_theta == data->pixelate_cos_theta &&
+	    data->voronoi_map_sin_theta == data->pixelate_sin_theta) {
+		return gs_texrender_get_texture(data->voronoi_seed_map);
+	}
+
+	struct vec2 uv_size;
+	uv_size.x = (float)data->width;
+	uv_size.y = (float)data->height;
+	effect_param_set_vec2(&data->param_jfa_uv_size, &uv_size);
+	effect_param_set_float(&data->param_jfa_pixel_size, radius);
+	effect_param_set_vec2(&data->param_jfa_tess_origin,
+			      &data->pixelate_tessel_center);
+	effect_param_set_float(&data->param_jfa_cos_theta,
+			       data->pixelate_cos_theta);
+	effect_param_set_float(&data->param_jfa_sin_theta,
+			       data->pixelate_sin_theta);
+	effect_param_set_float(&data->param_jfa_time, data->time);
+
+	set_blending_parameters();
+
+	// 1. Splat seeds into the map. Texels hold the seed's grid cell
+	//    and time layer, which need 32 bit floats but only two
+	//    channels.
+	data->voronoi_seed_map = create_or_reset_texrender_format(
+		data->voronoi_seed_map, GS_RG32F);
+	if (gs_texrender_begin(data->voronoi_seed_map, data->width,
+			       data->height)) {
+		gs_ortho(0.0f, uv_size.x, 0.0f, uv_size.y, -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "Seed"))
+			gs_draw_sprite(NULL, 0, data->width, data->height);
+		gs_texrender_end(data->voronoi_seed_map);
+	}
+
+	// 2. Flood, halving the step from the largest seed distance
+	//    (about 1.5 grid cells of 2 * pixel_size) down to 1, with a
+	//    final extra step of 1 to clean up JFA errors.
+	int step = 1;
+	while ((float)step < 3.0f * radius && step < 4096) {
+		step *= 2;
+	}
+	for (int pass_step = step; pass_step >= 1; pass_step /= 2) {
+		for (int k = 0; k < (pass_step == 1 ? 2 : 1); k++) {
+			gs_texrender_t *tmp = data->voronoi_seed_map2;
+			data->voronoi_seed_map2 = data->voronoi_seed_map;
+			data->voronoi_seed_map = tmp;
+			data->voronoi_seed_map = create_or_reset_texrender_format(
+				data->voronoi_seed_map, GS_RG32F);
+
+			gs_texture_t *texture = gs_texrender_get_texture(
+				data->voronoi_seed_map2);
+			effect_param_set_texture(&data->param_jfa_image,
+						 texture);
+			effect_param_set_float(&data->param_jfa_jump,
+					       (float)pass_step);
+			if (gs_texrender_begin(data->voronoi_seed_map,
+					       data->width, data->height)) {
+				gs_ortho(0.0f, uv_size.x, 0.0f, uv_size.y,
+					 -100.0f, 100.0f);
+				while (gs_effect_loop(effect, "Flood"))
+					gs_draw_sprite(texture, 0,
+						       data->width,
+						       data->height);
+				gs_texrender_end(data->voronoi_seed_map);
+			}
+		}
+	}
+
+	gs_blend_state_pop();
+
+	data->voronoi_seed_map_valid = true;
+	data->voronoi_map_width = data->width;
+	data->voronoi_map_height = data->height;
+	data->voronoi_map_pixel_size = radius;
+	data->voronoi_map_time = data->time;
+	data->voronoi_map_origin = data->pixelate_tessel_center;
+	data->voronoi_map_cos_theta = data->pixelate_cos_theta;
+	data->voronoi_map_sin_theta = data->pixelate_sin_theta;
+
+	return gs_texrender_get_texture(data->voronoi_seed_map);
+}
+
 static void load_pixelate_square_effect(composite_blur_filter_data_t *filter)
 {
 	if (filter->pixelate_effect != NULL) {
@@ -186,7 +515,11 @@ static void load_pixelate_square_effect(composite_blur_filter_data_t *filter)
 				filter->pixelate_effect, effect_index);
 			struct gs_effect_param_info info;
 			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
+			if (strcmp(info.name, "image_lod") == 0) {
+				filter->param_pixel_image_lod = param;
+			} else if (strcmp(info.name, "lod_mix") == 0) {
+				filter->param_pixel_lod_mix = param;
+			} else if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			} else if (strcmp(info.name, "pixel_size") == 0) {
 				filter->param_pixel_size = param;
@@ -208,6 +541,78 @@ static void load_pixelate_square_effect(composite_blur_filter_data_t *filter)
 	}
 }
 
+static void
+load_pixelate_square_cells_effect(composite_blur_filter_data_t *filter)
+{
+	if (filter->pixelate_cells_effect != NULL) {
+		obs_enter_graphics();
+		gs_effect_destroy(filter->pixelate_cells_effect);
+		filter->pixelate_cells_effect = NULL;
+		obs_leave_graphics();
+	}
+
+	const char *effect_file_path = "/shaders/pixelate_square_cells.effect";
+	filter->pixelate_cells_effect = load_shader_effect(
+		filter->pixelate_cells_effect, effect_file_path);
+	effect_param_init(&filter->param_cells_image, NULL);
+	effect_param_init(&filter->param_cells_cells, NULL);
+	effect_param_init(&filter->param_cells_uv_size, NULL);
+	effect_param_init(&filter->param_cells_pixel_size, NULL);
+	effect_param_init(&filter->param_cells_tess_origin, NULL);
+	effect_param_init(&filter->param_cells_cos_theta, NULL);
+	effect_param_init(&filter->param_cells_sin_theta, NULL);
+	effect_param_init(&filter->param_cells_cos_rtheta, NULL);
+	effect_param_init(&filter->param_cells_sin_rtheta, NULL);
+	effect_param_init(&filter->param_cells_cell_min, NULL);
+	effect_param_init(&filter->param_cells_cell_count, NULL);
+	if (filter->pixelate_cells_effect) {
+		size_t effect_count =
+			gs_effect_get_num_params(filter->pixelate_cells_effect);
+		for (size_t effect_index = 0; effect_index < effect_count;
+		     effect_index++) {
+			gs_eparam_t *param = gs_effect_get_param_by_idx(
+				filter->pixelate_cells_effect, effect_index);
+			struct gs_effect_param_info info;
+			gs_effect_get_param_info(param, &info);
+			if (strcmp(info.name, "image") == 0) {
+				effect_param_init(&filter->param_cells_image,
+						  param);
+			} else if (strcmp(info.name, "cells") == 0) {
+				effect_param_init(&filter->param_cells_cells,
+						  param);
+			} else if (strcmp(info.name, "uv_size") == 0) {
+				effect_param_init(&filter->param_cells_uv_size,
+						  param);
+			} else if (strcmp(info.name, "pixel_size") == 0) {
+				effect_param_init(
+					&filter->param_cells_pixel_size, param);
+			} else if (strcmp(info.name, "tess_origin") == 0) {
+				effect_param_init(
+					&filter->param_cells_tess_origin,
+					param);
+			} else if (strcmp(info.name, "cos_theta") == 0) {
+				effect_param_init(
+					&filter->param_cells_cos_theta, param);
+			} else if (strcmp(info.name, "sin_theta") == 0) {
+				effect_param_init(
+					&filter->param_cells_sin_theta, param);
+			} else if (strcmp(info.name, "cos_rtheta") == 0) {
+				effect_param_init(
+					&filter->param_cells_cos_rtheta, param);
+			} else if (strcmp(info.name, "sin_rtheta") == 0) {
+				effect_param_init(
+					&filter->param_cells_sin_rtheta, param);
+			} else if (strcmp(info.name, "cell_min") == 0) {
+				effect_param_init(&filter->param_cells_cell_min,
+						  param);
+			} else if (strcmp(info.name, "cell_count") == 0) {
+				effect_param_init(
+					&filter->param_cells_cell_count, param);
+			}
+		}
+	}
+}
+
 static void load_pixelate_hexagonal_effect(composite_blur_filter_data_t *filter)
 {
 	if (filter->pixelate_effect != NULL) {
@@ -229,7 +634,13 @@ static void load_pixelate_hexagonal_effect(composite_blur_filter_data_t *filter)
 				filter->pixelate_effect, effect_index);
 			struct gs_effect_param_info info;
 			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
+			if (strcmp(info.name, "image_lod") == 0) {
+				filter->param_pixel_image_lod = param;
+			} else if (strcmp(info.name, "cell_map") == 0) {
+				filter->param_pixel_cell_map = param;
+			} else if (strcmp(info.name, "lod_mix") == 0) {
+				filter->param_pixel_lod_mix = param;
+			} else if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			} else if (strcmp(info.name, "pixel_size") == 0) {
 				filter->param_pixel_size = param;
@@ -272,7 +683,13 @@ static void load_pixelate_circle_effect(composite_blur_filter_data_t *filter)
 				filter->pixelate_effect, effect_index);
 			struct gs_effect_param_info info;
 			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
+			if (strcmp(info.name, "image_lod") == 0) {
+				filter->param_pixel_image_lod = param;
+			} else if (strcmp(info.name, "cell_map") == 0) {
+				filter->param_pixel_cell_map = param;
+			} else if (strcmp(info.name, "lod_mix") == 0) {
+				filter->param_pixel_lod_mix = param;
+			} else if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			} else if (strcmp(info.name, "pixel_size") == 0) {
 				filter->param_pixel_size = param;
@@ -315,7 +732,13 @@ static void load_pixelate_triangle_effect(composite_blur_filter_data_t *filter)
 				filter->pixelate_effect, effect_index);
 			struct gs_effect_param_info info;
 			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
+			if (strcmp(info.name, "image_lod") == 0) {
+				filter->param_pixel_image_lod = param;
+			} else if (strcmp(info.name, "cell_map") == 0) {
+				filter->param_pixel_cell_map = param;
+			} else if (strcmp(info.name, "lod_mix") == 0) {
+				filter->param_pixel_lod_mix = param;
+			} else if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			} else if (strcmp(info.name, "pixel_size") == 0) {
 				filter->param_pixel_size = param;
@@ -358,7 +781,13 @@ static void load_pixelate_voronoi_effect(composite_blur_filter_data_t* filter)
 				filter->pixelate_effect, effect_index);
 			struct gs_effect_param_info info;
 			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
+			if (strcmp(info.name, "image_lod") == 0) {
+				filter->param_pixel_image_lod = param;
+			}
+			else if (strcmp(info.name, "lod_mix") == 0) {
+				filter->param_pixel_lod_mix = param;
+			}
+			else if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			}
 			else if (strcmp(info.name, "pixel_size") == 0) {
@@ -385,8 +814,65 @@ static void load_pixelate_voronoi_effect(composite_blur_filter_data_t* filter)
 			else if (strcmp(info.name, "time") == 0) {
 				filter->param_pixel_time = param;
 			}
+			else if (strcmp(info.name, "seed_map") == 0) {
+				filter->param_pixel_seed_map = param;
+			}
+		}
+	}
+}
+
+static void
+load_pixelate_voronoi_jfa_effect(composite_blur_filter_data_t *filter)
+{
+	const char *effect_file_path = "/shaders/pixelate_voronoi_jfa.effect";
+	filter->voronoi_jfa_effect =
+		load_shader_effect(filter->voronoi_jfa_effect, effect_file_path);
+	filter->voronoi_seed_map_valid = false;
+	effect_param_init(&filter->param_jfa_image, NULL);
+	effect_param_init(&filter->param_jfa_jump, NULL);
+	effect_param_init(&filter->param_jfa_uv_size, NULL);
+	effect_param_init(&filter->param_jfa_pixel_size, NULL);
+	effect_param_init(&filter->param_jfa_tess_origin, NULL);
+	effect_param_init(&filter->param_jfa_cos_theta, NULL);
+	effect_param_init(&filter->param_jfa_sin_theta, NULL);
+	effect_param_init(&filter->param_jfa_time, NULL);
+	if (filter->voronoi_jfa_effect) {
+		size_t effect_count =
+			gs_effect_get_num_params(filter->voronoi_jfa_effect);
+		for (size_t effect_index = 0; effect_index < effect_count;
+		     effect_index++) {
+			gs_eparam_t *param = gs_effect_get_param_by_idx(
+				filter->voronoi_jfa_effect, effect_index);
+			struct gs_effect_param_info info;
+			gs_effect_get_param_info(param, &info);
+			if (strcmp(info.name, "image") == 0) {
+				effect_param_init(&filter->param_jfa_image,
+						  param);
+			} else if (strcmp(info.name, "jump") == 0) {
+				effect_param_init(&filter->param_jfa_jump,
+						  param);
+			} else if (strcmp(info.name, "uv_size") == 0) {
+				effect_param_init(&filter->param_jfa_uv_size,
+						  param);
+			} else if (strcmp(info.name, "pixel_size") == 0) {
+				effect_param_init(&filter->param_jfa_pixel_size,
+						  param);
+			} else if (strcmp(info.name, "tess_origin") == 0) {
+				effect_param_init(
+					&filter->param_jfa_tess_origin, param);
+			} else if (strcmp(info.name, "cos_theta") == 0) {
+				effect_param_init(&filter->param_jfa_cos_theta,
+						  param);
+			} else if (strcmp(info.name, "sin_theta") == 0) {
+				effect_param_init(&filter->param_jfa_sin_theta,
+						  param);
+			} else if (strcmp(info.name, "time") == 0) {
+				effect_param_init(&filter->param_jfa_time,
+						  param);
+			}
 		}
 	}
+
 }
 
 static void load_pixelate_rhomboid_effect(composite_blur_filter_data_t* filter)
@@ -410,7 +896,16 @@ static void load_pixelate_rhomboid_effect(composite_blur_filter_data_t* filter)
 				filter->pixelate_effect, effect_index);
 			struct gs_effect_param_info info;
 			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
+			if (strcmp(info.name, "image_lod") == 0) {
+				filter->param_pixel_image_lod = param;
+			}
+			else if (strcmp(info.name, "cell_map") == 0) {
+				filter->param_pixel_cell_map = param;
+			}
+			else if (strcmp(info.name, "lod_mix") == 0) {
+				filter->param_pixel_lod_mix = param;
+			}
+			else if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			}
 			else if (strcmp(info.name, "pixel_size") == 0) {
@@ -460,7 +955,16 @@ static void load_pixelate_triakis_effect(composite_blur_filter_data_t* filter)
 				filter->pixelate_effect, effect_index);
 			struct gs_effect_param_info info;
 			gs_effect_get_param_info(param, &info);
-			if (strcmp(info.name, "uv_size") == 0) {
+			if (strcmp(info.name, "image_lod") == 0) {
+				filter->param_pixel_image_lod = param;
+			}
+			else if (strcmp(info.name, "cell_map") == 0) {
+				filter->param_pixel_cell_map = param;
+			}
+			else if (strcmp(info.name, "lod_mix") == 0) {
+				filter->param_pixel_lod_mix = param;
+			}
+			else if (strcmp(info.name, "uv_size") == 0) {
 				filter->param_uv_size = param;
 			}
 			else if (strcmp(info.name, "pixel_size") == 0) {
@@ -6,6 +6,9 @@
 #include "../obs-composite-blur-filter.h"
 
 #define MIN_PIXELATE_BLUR_SIZE 1.01f
+// Taps per axis used to average a cell, must match CELL_TAPS in
+// pixelate_square_cells.effect.
+#define PIXELATE_CELL_TAPS 4
 
 extern void set_pixelate_blur_types(obs_properties_t *props);
 extern void pixelate_setup_callbacks(composite_blur_filter_data_t *data);
@@ -13,12 +16,23 @@ extern void render_video_pixelate(composite_blur_filter_data_t *data);
 extern void load_effect_pixelate(composite_blur_filter_data_t *filter);
 
 static void pixelate_square_blur(composite_blur_filter_data_t *data);
+static void pixelate_cell_average(composite_blur_filter_data_t *data,
+				  float radius);
+static gs_texture_t *
+pixelate_voronoi_seed_map(composite_blur_filter_data_t *data, float radius);
+static bool pixelate_type_has_cell_map(int pixelate_type);
+static gs_texture_t *pixelate_bake_cell_map(composite_blur_filter_data_t *data,
+					    gs_effect_t *effect, float radius);
 
 static void load_pixelate_square_effect(composite_blur_filter_data_t *filter);
 static void
+load_pixelate_square_cells_effect(composite_blur_filter_data_t *filter);
+static void
 load_pixelate_hexagonal_effect(composite_blur_filter_data_t *filter);
 static void load_pixelate_circle_effect(composite_blur_filter_data_t *filter);
 static void load_pixelate_triangle_effect(composite_blur_filter_data_t *filter);
 static void load_pixelate_voronoi_effect(composite_blur_filter_data_t* filter);
+static void
+load_pixelate_voronoi_jfa_effect(composite_blur_filter_data_t *filter);
 static void load_pixelate_rhomboid_effect(composite_blur_filter_data_t* filter);
 static void load_pixelate_triakis_effect(composite_blur_filter_data_t* filter);
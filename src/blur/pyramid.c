@@ -0,0 +1,148 @@
+#include "pyramid.h"
+
+// Resolves the handles used to build levels. Binding NULL leaves
+// effect_down unusable until the effect is loaded again.
+void pyramid_effect_bind(pyramid_effect_t *effect_down, gs_effect_t *effect)
+{
+	effect_down->effect = effect;
+	gs_eparam_t *image = NULL;
+	gs_eparam_t *texel_step = NULL;
+	if (effect) {
+		size_t effect_count = gs_effect_get_num_params(effect);
+		for (size_t effect_index = 0; effect_index < effect_count;
+		     effect_index++) {
+			gs_eparam_t *param =
+				gs_effect_get_param_by_idx(effect, effect_index);
+			struct gs_effect_param_info info;
+			gs_effect_get_param_info(param, &info);
+			if (strcmp(info.name, "image") == 0) {
+				image = param;
+			} else if (strcmp(info.name, "texel_step") == 0) {
+				texel_step = param;
+			}
+		}
+	}
+	effect_param_init(&effect_down->image, image);
+	effect_param_init(&effect_down->texel_step, texel_step);
+}
+
+/*
+ *  Returns the pyramid for source in the current frame. Pyramids are
+ *  cached per input texture, effect and technique, so consumers that
+ *  smooth the same input in the same frame (kawase, pixelate smoothing,
+ *  vector smoothing) share the down sample chain. When source is not
+ *  cached, the entry used least recently is reset for it.
+ */
+blur_pyramid_t *pyramid_acquire(blur_pyramid_t *cache,
+			       pyramid_effect_t *effect_down,
+			       gs_texture_t *source, const char *technique)
+{
+	const uint64_t frame_time = obs_get_video_frame_time();
+	const uint32_t width = gs_texture_get_width(source);
+	const uint32_t height = gs_texture_get_height(source);
+	const enum gs_color_format format = gs_texture_get_color_format(source);
+
+	blur_pyramid_t *oldest = &cache[0];
+	for (size_t i = 0; i < PYRAMID_CACHE_SIZE; i++) {
+		blur_pyramid_t *pyramid = &cache[i];
+		if (pyramid->source == source &&
+		    pyramid->effect == effect_down->effect &&
+		    pyramid->technique &&
+		    strcmp(pyramid->technique, technique) == 0 &&
+		    pyramid->frame_time == frame_time &&
+		    pyramid->width == width && pyramid->height == height &&
+		    pyramid->format == format) {
+			return pyramid;
+		}
+		if (pyramid->frame_time < oldest->frame_time) {
+			oldest = pyramid;
+		}
+	}
+
+	// Prefer an entry already holding targets of the same format, so
+	// its level texrenders are reset rather than recreated.
+	for (size_t i = 0; i < PYRAMID_CACHE_SIZE; i++) {
+		blur_pyramid_t *pyramid = &cache[i];
+		if (pyramid->format == format &&
+		    pyramid->frame_time != frame_time) {
+			oldest = pyramid;
+			break;
+		}
+	}
+
+	oldest->source = source;
+	oldest->effect_down = effect_down;
+	oldest->effect = effect_down->effect;
+	oldest->technique = technique;
+	oldest->frame_time = frame_time;
+	oldest->width = width;
+	oldest->height = height;
+	oldest->format = format;
+	oldest->levels = 0;
+	return oldest;
+}
+
+static void pyramid_build_level(blur_pyramid_t *pyramid, int level)
+{
+	pyramid_effect_t *effect_down = pyramid->effect_down;
+	gs_texture_t *input_texture =
+		level == 1 ? pyramid->source
+			   : gs_texrender_get_texture(pyramid->level[level - 1]);
+
+	pyramid->level[level] = create_or_reset_texrender_format(
+		pyramid->level[level], pyramid->format);
+
+	uint32_t w = pyramid->width >> level;
+	uint32_t h = pyramid->height >> level;
+	w = w > 0 ? w : 1;
+	h = h > 0 ? h : 1;
+
+	effect_param_set_texture(&effect_down->image, input_texture);
+
+	struct vec2 texel_step_size;
+	texel_step_size.x = 1.0f / (float)w;
+	texel_step_size.y = 1.0f / (float)h;
+	effect_param_set_vec2(&effect_down->texel_step, &texel_step_size);
+
+	if (gs_texrender_begin(pyramid->level[level], w, h)) {
+		gs_ortho(0.0f, (float)w, 0.0f, (float)h, -100.0f, 100.0f);
+		while (gs_effect_loop(effect_down->effect, pyramid->technique))
+			gs_draw_sprite(input_texture, 0, w, h);
+		gs_texrender_end(pyramid->level[level]);
+	}
+	pyramid->levels = level;
+}
+
+/*
+ *  Returns level of the pyramid, building any missing levels down to
+ *  it. Expects the caller to have set up blending.
+ */
+gs_texture_t *pyramid_get_level(blur_pyramid_t *pyramid, int level)
+{
+	if (level <= 0 || !pyramid->effect) {
+		return pyramid->source;
+	}
+	if (level > PYRAMID_MAX_LEVELS) {
+		level = PYRAMID_MAX_LEVELS;
+	}
+	for (int i = pyramid->levels + 1; i <= level; i++) {
+		pyramid_build_level(pyramid, i);
+	}
+	return gs_texrender_get_texture(pyramid->level[level]);
+}
+
+void pyramid_cache_free(blur_pyramid_t *cache)
+{
+	for (size_t i = 0; i < PYRAMID_CACHE_SIZE; i++) {
+		for (int j = 0; j <= PYRAMID_MAX_LEVELS; j++) {
+			if (cache[i].level[j]) {
+				gs_texrender_destroy(cache[i].level[j]);
+				cache[i].level[j] = NULL;
+			}
+		}
+		cache[i].levels = 0;
+		cache[i].source = NULL;
+		cache[i].effect_down = NULL;
+		cache[i].effect = NULL;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <obs-module.h>
+#include "../obs-utils.h"
+#include "../effect-param.h"
+
+#define PYRAMID_MAX_LEVELS 16
+#define PYRAMID_CACHE_SIZE 3
+
+// Effect the levels are built with, and its handles, bound when the
+// effect loads.
+typedef struct pyramid_effect {
+	gs_effect_t *effect;
+	effect_param_t image;
+	effect_param_t texel_step;
+} pyramid_effect_t;
+
+// Chain of successively halved copies of one input texture, built
+// with a technique of a down sample effect ("Draw" of the kawase down
+// sample for the kawase filter, "DrawBox" for a plain box mip chain).
+// Level n is 1/2^n of the input size, level 0 is the input itself.
+typedef struct blur_pyramid {
+	gs_texture_t *source;
+	pyramid_effect_t *effect_down;
+	gs_effect_t *effect;
+	const char *technique;
+	uint64_t frame_time;
+	uint32_t width;
+	uint32_t height;
+	enum gs_color_format format;
+	int levels;
+	gs_texrender_t *level[PYRAMID_MAX_LEVELS + 1];
+} blur_pyramid_t;
+
+extern void pyramid_effect_bind(pyramid_effect_t *effect_down,
+				gs_effect_t *effect);
+extern blur_pyramid_t *pyramid_acquire(blur_pyramid_t *cache,
+				       pyramid_effect_t *effect_down,
+				       gs_texture_t *source,
+				       const char *technique);
+extern gs_texture_t *pyramid_get_level(blur_pyramid_t *pyramid, int level);
+extern void pyramid_cache_free(blur_pyramid_t *cache);
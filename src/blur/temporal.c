@@ -17,6 +17,58 @@ void load_effect_temporal(composite_blur_filter_data_t* filter)
 	load_temporal_effect(filter);
 }
 
+static int temporal_frame_count(composite_blur_filter_data_t* data)
+{
+	const int frames = data->temporal_frames;
+	return frames < 1 ? 1
+	       : frames > TEMPORAL_MAX_FRAMES ? TEMPORAL_MAX_FRAMES
+					      : frames;
+}
+
+void temporal_reset_history(composite_blur_filter_data_t* data)
+{
+	// Ring slots past the current window are never reached again.
+	const int frames = data->temporal_mode == TEMPORAL_MODE_BOX
+				   ? temporal_frame_count(data)
+				   : 0;
+	for (int i = frames; i < TEMPORAL_MAX_FRAMES; i++) {
+		if (data->temporal_ring[i]) {
+			gs_texrender_destroy(data->temporal_ring[i]);
+			data->temporal_ring[i] = NULL;
+		}
+	}
+	data->temporal_prior_stored = false;
+	data->temporal_ring_head = 0;
+	data->temporal_ring_count = 0;
+}
+
+void temporal_free_history(composite_blur_filter_data_t* data)
+{
+	if (data->temporal_history) {
+		gs_texrender_destroy(data->temporal_history);
+		data->temporal_history = NULL;
+	}
+	for (int i = 0; i < TEMPORAL_MAX_FRAMES; i++) {
+		if (data->temporal_ring[i]) {
+			gs_texrender_destroy(data->temporal_ring[i]);
+			data->temporal_ring[i] = NULL;
+		}
+	}
+	if (data->temporal_sum) {
+		gs_texrender_destroy(data->temporal_sum);
+		data->temporal_sum = NULL;
+	}
+	if (data->temporal_sum2) {
+		gs_texrender_destroy(data->temporal_sum2);
+		data->temporal_sum2 = NULL;
+	}
+	if (data->temporal_newest) {
+		gs_texrender_destroy(data->temporal_newest);
+		data->temporal_newest = NULL;
+	}
+	temporal_reset_history(data);
+}
+
 static void temporal_blur(composite_blur_filter_data_t* data)
 {
 	gs_effect_t* effect = data->effect;
@@ -28,6 +80,22 @@ static void temporal_blur(composite_blur_filter_data_t* data)
 
 	texture = blend_composite(texture, data);
 
+	// History is kept at 1/scale of the frame, and is restarted
+	// whenever the frame size changes.
+	const uint32_t scale = data->temporal_history_scale > 0
+				       ? (uint32_t)data->temporal_history_scale
+				       : 1;
+	uint32_t history_width = data->width / scale;
+	uint32_t history_height = data->height / scale;
+	history_width = history_width > 0 ? history_width : 1;
+	history_height = history_height > 0 ? history_height : 1;
+	if (history_width != data->temporal_history_width ||
+	    history_height != data->temporal_history_height) {
+		data->temporal_history_width = history_width;
+		data->temporal_history_height = history_height;
+		temporal_reset_history(data);
+	}
+
 	if (data->param_temporal_image) {
 		gs_effect_set_texture(data->param_temporal_image, texture);
 	}
@@ -40,16 +108,27 @@ static void temporal_blur(composite_blur_filter_data_t* data)
 		gs_effect_set_float(data->param_temporal_clear_threshold, data->temporal_clear_threshold);
 	}
 
+	if (data->temporal_mode == TEMPORAL_MODE_BOX) {
+		temporal_blur_box(data, texture);
+		return;
+	}
+
+	// At full size the prior is last frame's output as is, so the two
+	// targets are swapped rather than the output copied into history.
+	const bool swap_history = scale == 1;
+	if (swap_history && data->temporal_prior_stored) {
+		gs_texrender_t* tmp = data->temporal_history;
+		data->temporal_history = data->output_texrender;
+		data->output_texrender = tmp;
+	}
+
 	gs_texture_t* prior_texture;
 
-	if (!data->temporal_prior_stored) {
+	if (!data->temporal_prior_stored || !data->temporal_history) {
 		prior_texture = texture;
 		data->temporal_prior_stored = true;
 	} else {
-		gs_texrender_t* tmp = data->render;
-		data->render = data->output_texrender;
-		data->output_texrender = tmp;
-		prior_texture = gs_texrender_get_texture(data->render);
+		prior_texture = gs_texrender_get_texture(data->temporal_history);
 	}
 
 	if (data->param_temporal_prior_image) {
@@ -70,6 +149,171 @@ static void temporal_blur(composite_blur_filter_data_t* data)
 	}
 
 	gs_blend_state_pop();
+
+	// The trail feeds back on itself, so the output (not the input)
+	// becomes next frame's prior.
+	if (!swap_history) {
+		data->temporal_history =
+			create_or_reset_texrender(data->temporal_history);
+		temporal_store(data,
+			       gs_texrender_get_texture(data->output_texrender),
+			       data->temporal_history);
+	}
+}
+
+/*
+ *  Box average of the last temporal_frames frames. A running sum is
+ *  updated with the newest frame and the frame leaving the window, so
+ *  the cost per frame is constant regardless of the window length.
+ */
+static void temporal_blur_box(composite_blur_filter_data_t* data,
+			      gs_texture_t* texture)
+{
+	gs_effect_t* effect = data->effect;
+	const uint32_t w = data->temporal_history_width;
+	const uint32_t h = data->temporal_history_height;
+	const int frames = temporal_frame_count(data);
+
+	const bool restart = data->temporal_ring_count == 0 ||
+			     !data->temporal_sum;
+	const bool full = !restart && data->temporal_ring_count == frames;
+	if (restart) {
+		data->temporal_ring_head = 0;
+		data->temporal_ring_count = 0;
+	}
+	gs_texrender_t* oldest = data->temporal_ring[data->temporal_ring_head];
+
+	// 1. Store the newest frame at the history resolution first, so the
+	//    sum adds exactly the (scaled and quantized) values the ring
+	//    subtracts once the frame leaves the window.
+	data->temporal_newest = create_or_reset_texrender(data->temporal_newest);
+	temporal_store(data, texture, data->temporal_newest);
+	gs_texture_t* newest = gs_texrender_get_texture(data->temporal_newest);
+
+	// 2. sum' = sum + newest - oldest, into the other half of the
+	//    ping-pong pair. Sums are kept in 32 bit float so the add and
+	//    subtract do not drift over long runs.
+	data->temporal_sum2 =
+		create_or_reset_texrender_format(data->temporal_sum2, GS_RGBA32F);
+	gs_texture_t* sum_texture = restart ? newest
+					    : gs_texrender_get_texture(data->temporal_sum);
+	gs_texture_t* oldest_texture = full && oldest
+					       ? gs_texrender_get_texture(oldest)
+					       : newest;
+	if (data->param_temporal_image) {
+		gs_effect_set_texture(data->param_temporal_image, newest);
+	}
+	if (data->param_temporal_sum_image) {
+		gs_effect_set_texture(data->param_temporal_sum_image, sum_texture);
+	}
+	if (data->param_temporal_oldest_image) {
+		gs_effect_set_texture(data->param_temporal_oldest_image,
+				      oldest_texture);
+	}
+	if (data->param_temporal_sum_weight) {
+		gs_effect_set_float(data->param_temporal_sum_weight,
+				    restart ? 0.0f : 1.0f);
+	}
+	if (data->param_temporal_oldest_weight) {
+		gs_effect_set_float(data->param_temporal_oldest_weight,
+				    full && oldest ? 1.0f : 0.0f);
+	}
+
+	set_blending_parameters();
+
+	if (gs_texrender_begin(data->temporal_sum2, w, h)) {
+		gs_ortho(0.0f, (float)w, 0.0f, (float)h, -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "Accumulate"))
+			gs_draw_sprite(newest, 0, w, h);
+		gs_texrender_end(data->temporal_sum2);
+	}
+
+	gs_blend_state_pop();
+
+	gs_texrender_t* tmp = data->temporal_sum;
+	data->temporal_sum = data->temporal_sum2;
+	data->temporal_sum2 = tmp;
+
+	// 3. The newest frame replaces the oldest in the ring, and the
+	//    oldest's target takes the next frame.
+	data->temporal_ring[data->temporal_ring_head] = data->temporal_newest;
+	data->temporal_newest = oldest;
+	data->temporal_ring_head = (data->temporal_ring_head + 1) % frames;
+	if (data->temporal_ring_count < frames) {
+		data->temporal_ring_count++;
+	}
+
+	// 4. Resolve the average at full resolution.
+	if (data->param_temporal_image) {
+		gs_effect_set_texture(data->param_temporal_image, texture);
+	}
+	if (data->param_temporal_sum_image) {
+		gs_effect_set_texture(data->param_temporal_sum_image,
+				      gs_texrender_get_texture(data->temporal_sum));
+	}
+	if (data->param_temporal_frame_count) {
+		gs_effect_set_float(data->param_temporal_frame_count,
+				    (float)data->temporal_ring_count);
+	}
+
+	data->output_texrender = create_or_reset_texrender(data->output_texrender);
+
+	set_blending_parameters();
+
+	if (gs_texrender_begin(data->output_texrender, data->width,
+		data->height)) {
+		gs_ortho(0.0f, (float)data->width, 0.0f, (float)data->height,
+			-100.0f, 100.0f);
+		while (gs_effect_loop(effect, "DrawBoxAverage"))
+			gs_draw_sprite(texture, 0, data->width, data->height);
+		gs_texrender_end(data->output_texrender);
+	}
+
+	gs_blend_state_pop();
+}
+
+/*
+ *  Copies texture into dest at the history resolution, averaging the
+ *  block of frame pixels under each history pixel.
+ */
+static void temporal_store(composite_blur_filter_data_t* data,
+			   gs_texture_t* texture, gs_texrender_t* dest)
+{
+	gs_effect_t* effect = data->effect;
+	const uint32_t w = data->temporal_history_width;
+	const uint32_t h = data->temporal_history_height;
+	if (!dest || !texture) {
+		return;
+	}
+
+	if (data->param_temporal_image) {
+		gs_effect_set_texture(data->param_temporal_image, texture);
+	}
+	if (data->param_temporal_store_offset) {
+		// A plain copy at full size, where the taps coincide.
+		const uint32_t scale =
+			data->temporal_history_scale > 1
+				? (uint32_t)data->temporal_history_scale
+				: 1;
+		struct vec2 offset;
+		vec2_set(&offset,
+			 scale > 1 ? 0.25f * (float)scale / (float)data->width
+				   : 0.0f,
+			 scale > 1 ? 0.25f * (float)scale / (float)data->height
+				   : 0.0f);
+		gs_effect_set_vec2(data->param_temporal_store_offset, &offset);
+	}
+
+	set_blending_parameters();
+
+	if (gs_texrender_begin(dest, w, h)) {
+		gs_ortho(0.0f, (float)w, 0.0f, (float)h, -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "Store"))
+			gs_draw_sprite(texture, 0, w, h);
+		gs_texrender_end(dest);
+	}
+
+	gs_blend_state_pop();
 }
 
 static void load_temporal_effect(composite_blur_filter_data_t* filter)
@@ -84,6 +328,7 @@ static void load_temporal_effect(composite_blur_filter_data_t* filter)
 	const char* effect_file_path = "/shaders/temporal_blur.effect";
 	filter->effect =
 		load_shader_effect(filter->effect, effect_file_path);
+	effect_param_init(&filter->param_dither_strength, NULL);
 	if (filter->effect) {
 		size_t effect_count =
 			gs_effect_get_num_params(filter->effect);
@@ -101,6 +346,18 @@ static void load_temporal_effect(composite_blur_filter_data_t* filter)
 				filter->param_temporal_current_weight = param;
 			} else if (strcmp(info.name, "clear_threshold") == 0) {
 				filter->param_temporal_clear_threshold = param;
+			} else if (strcmp(info.name, "sum_image") == 0) {
+				filter->param_temporal_sum_image = param;
+			} else if (strcmp(info.name, "oldest_image") == 0) {
+				filter->param_temporal_oldest_image = param;
+			} else if (strcmp(info.name, "sum_weight") == 0) {
+				filter->param_temporal_sum_weight = param;
+			} else if (strcmp(info.name, "oldest_weight") == 0) {
+				filter->param_temporal_oldest_weight = param;
+			} else if (strcmp(info.name, "frame_count") == 0) {
+				filter->param_temporal_frame_count = param;
+			} else if (strcmp(info.name, "store_offset") == 0) {
+				filter->param_temporal_store_offset = param;
 			}
 		}
 	}
@@ -7,7 +7,14 @@
 extern void temporal_setup_callbacks(composite_blur_filter_data_t* data);
 extern void render_video_temporal(composite_blur_filter_data_t* data);
 extern void load_effect_temporal(composite_blur_filter_data_t* filter);
+extern void temporal_reset_history(composite_blur_filter_data_t* data);
+extern void temporal_free_history(composite_blur_filter_data_t* data);
 
+static int temporal_frame_count(composite_blur_filter_data_t* data);
 static void temporal_blur(composite_blur_filter_data_t* data);
+static void temporal_blur_box(composite_blur_filter_data_t* data,
+			      gs_texture_t* texture);
+static void temporal_store(composite_blur_filter_data_t* data,
+			   gs_texture_t* texture, gs_texrender_t* dest);
 
 static void load_temporal_effect(composite_blur_filter_data_t* filter);
@@ -0,0 +1,71 @@
+#include "effect-param.h"
+
+// Called from the effect's load. A NULL handle makes every setter a
+// no-op, and forgets the value last set.
+void effect_param_init(effect_param_t *param, gs_eparam_t *handle)
+{
+	memset(param, 0, sizeof(effect_param_t));
+	param->param = handle;
+}
+
+static void effect_param_set_value(effect_param_t *param, const void *value,
+				   size_t size)
+{
+	if (!param->param) {
+		return;
+	}
+	if (param->size == size && memcmp(param->value, value, size) == 0) {
+		return;
+	}
+	memcpy(param->value, value, size);
+	param->size = size;
+	gs_effect_set_val(param->param, value, size);
+}
+
+void effect_param_set_int(effect_param_t *param, int value)
+{
+	effect_param_set_value(param, &value, sizeof(int));
+}
+
+void effect_param_set_float(effect_param_t *param, float value)
+{
+	effect_param_set_value(param, &value, sizeof(float));
+}
+
+void effect_param_set_vec2(effect_param_t *param, const struct vec2 *value)
+{
+	const float v[2] = {value->x, value->y};
+	effect_param_set_value(param, v, sizeof(v));
+}
+
+// Textures are plain handles, so they are always passed on. The
+// texture behind a texrender changes when it is recreated.
+void effect_param_set_texture(effect_param_t *param, gs_texture_t *texture)
+{
+	if (param->param) {
+		gs_effect_set_texture(param->param, texture);
+	}
+}
+
+/*
+ *  Uploads the first used of count floats, rounded up to whole float4
+ *  elements, unless the effect already holds this version of the
+ *  array. Elements past used keep whatever was uploaded before, so the
+ *  shader must not read them (e.g. loops bounded by kernel_size).
+ */
+void effect_param_set_array(effect_param_t *param, const float *values,
+			    size_t count, size_t used, uint64_t version)
+{
+	if (!param->param || !values || count == 0) {
+		return;
+	}
+	if (param->version == version && param->size > 0) {
+		return;
+	}
+	size_t upload = (used + 3) & ~(size_t)3;
+	upload = upload > count ? count : upload;
+	upload = upload > 0 ? upload : 1;
+	gs_effect_set_val(param->param, values, upload * sizeof(float));
+	param->size = upload * sizeof(float);
+	param->version = version;
+}
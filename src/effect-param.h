@@ -0,0 +1,27 @@
+#pragma once
+
+#include <obs-module.h>
+
+#define EFFECT_PARAM_MAX_VALUE 16
+
+// Handle of an effect parameter, resolved once when the effect loads,
+// along with the last value set through it. Setters skip values the
+// effect already holds, so parameters set through a binding must not
+// be set directly as well.
+typedef struct effect_param {
+	gs_eparam_t *param;
+	size_t size;
+	uint8_t value[EFFECT_PARAM_MAX_VALUE];
+	uint64_t version;
+} effect_param_t;
+
+extern void effect_param_init(effect_param_t *param, gs_eparam_t *handle);
+extern void effect_param_set_int(effect_param_t *param, int value);
+extern void effect_param_set_float(effect_param_t *param, float value);
+extern void effect_param_set_vec2(effect_param_t *param,
+				  const struct vec2 *value);
+extern void effect_param_set_texture(effect_param_t *param,
+				     gs_texture_t *texture);
+extern void effect_param_set_array(effect_param_t *param, const float *values,
+				   size_t count, size_t used,
+				   uint64_t version);
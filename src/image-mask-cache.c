@@ -0,0 +1,203 @@
+#include "image-mask-cache.h"
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static image_mask_t *cache_head = NULL;
+// Created by the first decode, drained and destroyed on module unload.
+static os_task_queue_t *decode_queue = NULL;
+
+/*
+ *  Box filters 32 bit pixels from src (sw x sh) down to dst (dw x dh).
+ *  Every destination pixel averages the block of source pixels it
+ *  covers, so thin features in the mask fade rather than alias.
+ */
+static void downscale_rgba(const uint8_t *src, uint32_t sw, uint32_t sh,
+			   uint8_t *dst, uint32_t dw, uint32_t dh)
+{
+	for (uint32_t dy = 0; dy < dh; dy++) {
+		uint32_t sy0 = (uint32_t)((uint64_t)dy * sh / dh);
+		uint32_t sy1 = (uint32_t)((uint64_t)(dy + 1) * sh / dh);
+		sy1 = sy1 > sy0 ? sy1 : sy0 + 1;
+		for (uint32_t dx = 0; dx < dw; dx++) {
+			uint32_t sx0 = (uint32_t)((uint64_t)dx * sw / dw);
+			uint32_t sx1 =
+				(uint32_t)((uint64_t)(dx + 1) * sw / dw);
+			sx1 = sx1 > sx0 ? sx1 : sx0 + 1;
+			uint32_t sum[4] = {0, 0, 0, 0};
+			for (uint32_t y = sy0; y < sy1; y++) {
+				const uint8_t *row =
+					src + ((size_t)y * sw + sx0) * 4;
+				for (uint32_t x = sx0; x < sx1; x++) {
+					sum[0] += row[0];
+					sum[1] += row[1];
+					sum[2] += row[2];
+					sum[3] += row[3];
+					row += 4;
+				}
+			}
+			const uint32_t count = (sy1 - sy0) * (sx1 - sx0);
+			uint8_t *out = dst + ((size_t)dy * dw + dx) * 4;
+			for (int c = 0; c < 4; c++) {
+				out[c] = (uint8_t)((sum[c] + count / 2) /
+						   count);
+			}
+		}
+	}
+}
+
+static void image_mask_free(image_mask_t *mask)
+{
+	if (mask->texture) {
+		obs_enter_graphics();
+		gs_texture_destroy(mask->texture);
+		obs_leave_graphics();
+	}
+	bfree(mask->data);
+	bfree(mask->path);
+	bfree(mask);
+}
+
+static void image_mask_decode_task(void *param)
+{
+	image_mask_t *mask = param;
+
+	enum gs_color_format format = GS_UNKNOWN;
+	uint32_t cx = 0;
+	uint32_t cy = 0;
+	uint8_t *data =
+		gs_create_texture_file_data(mask->path, &format, &cx, &cy);
+
+	if (data && cx > 0 && cy > 0) {
+		// Masks are only ever sampled at the filter's resolution,
+		// so anything larger is averaged down before upload. Only
+		// 8 bit per channel formats are reduced, others (e.g. 16
+		// bit PNGs) are uploaded as decoded.
+		uint32_t w = cx < mask->max_width ? cx : mask->max_width;
+		uint32_t h = cy < mask->max_height ? cy : mask->max_height;
+		if ((w < cx || h < cy) && gs_get_format_bpp(format) == 32) {
+			uint8_t *scaled = bmalloc((size_t)w * h * 4);
+			downscale_rgba(data, cx, cy, scaled, w, h);
+			bfree(data);
+			data = scaled;
+			cx = w;
+			cy = h;
+		}
+		mask->data = data;
+		mask->format = format;
+		mask->width = cx;
+		mask->height = cy;
+	} else {
+		blog(LOG_WARNING,
+		     "[Composite Blur] Failed to load mask image '%s'",
+		     mask->path);
+		bfree(data);
+	}
+
+	os_atomic_store_bool(&mask->decoded, true);
+	image_mask_release(mask);
+}
+
+/*
+ *  Returns a reference to the cached mask for path at no more than
+ *  max_width x max_height, starting a background decode if this is
+ *  the first user. Must be balanced with image_mask_release.
+ */
+image_mask_t *image_mask_acquire(const char *path, uint32_t max_width,
+				 uint32_t max_height)
+{
+	if (!path || !*path || max_width == 0 || max_height == 0) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&cache_mutex);
+	for (image_mask_t *mask = cache_head; mask; mask = mask->next) {
+		if (mask->max_width == max_width &&
+		    mask->max_height == max_height &&
+		    strcmp(mask->path, path) == 0) {
+			os_atomic_inc_long(&mask->refs);
+			pthread_mutex_unlock(&cache_mutex);
+			return mask;
+		}
+	}
+
+	image_mask_t *mask = bzalloc(sizeof(image_mask_t));
+	mask->path = bstrdup(path);
+	mask->max_width = max_width;
+	mask->max_height = max_height;
+	// One reference for the caller, one for the decode task, so an
+	// entry is never freed while its decode is still running.
+	mask->refs = 2;
+	mask->next = cache_head;
+	cache_head = mask;
+	if (!decode_queue) {
+		decode_queue = os_task_queue_create();
+	}
+	const bool queued = decode_queue &&
+			    os_task_queue_queue_task(
+				    decode_queue, image_mask_decode_task, mask);
+	pthread_mutex_unlock(&cache_mutex);
+
+	if (!queued) {
+		os_atomic_store_bool(&mask->decoded, true);
+		image_mask_release(mask);
+	}
+	return mask;
+}
+
+/*
+ *  Waits for queued decodes to finish and stops the decode thread.
+ *  Called on module unload, so no decode outlives the plugin code.
+ */
+void image_mask_cache_shutdown(void)
+{
+	pthread_mutex_lock(&cache_mutex);
+	os_task_queue_t *queue = decode_queue;
+	decode_queue = NULL;
+	pthread_mutex_unlock(&cache_mutex);
+
+	// Destroying the queue runs the tasks already queued first.
+	if (queue) {
+		os_task_queue_destroy(queue);
+	}
+}
+
+void image_mask_release(image_mask_t *mask)
+{
+	if (!mask) {
+		return;
+	}
+
+	pthread_mutex_lock(&cache_mutex);
+	if (os_atomic_dec_long(&mask->refs) > 0) {
+		pthread_mutex_unlock(&cache_mutex);
+		return;
+	}
+	image_mask_t **prev = &cache_head;
+	while (*prev && *prev != mask) {
+		prev = &(*prev)->next;
+	}
+	if (*prev) {
+		*prev = mask->next;
+	}
+	pthread_mutex_unlock(&cache_mutex);
+
+	image_mask_free(mask);
+}
+
+/*
+ *  Graphics thread only. Returns NULL until the worker has finished
+ *  decoding, then uploads the pixels once and frees the CPU copy.
+ */
+gs_texture_t *image_mask_get_texture(image_mask_t *mask)
+{
+	if (!mask || !os_atomic_load_bool(&mask->decoded)) {
+		return NULL;
+	}
+	if (!mask->texture && mask->data) {
+		const uint8_t *data = mask->data;
+		mask->texture = gs_texture_create(mask->width, mask->height,
+						  mask->format, 1, &data, 0);
+		bfree(mask->data);
+		mask->data = NULL;
+	}
+	return mask->texture;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <obs-module.h>
+#include <util/threading.h>
+#include <util/task.h>
+
+// Decoded image mask shared by every filter instance using the same
+// file at the same size. Entries are decoded and downscaled on a worker
+// task queue and uploaded lazily on the graphics thread.
+typedef struct image_mask {
+	struct image_mask *next;
+	char *path;
+	uint32_t max_width;
+	uint32_t max_height;
+	volatile long refs;
+	volatile bool decoded;
+
+	// Written by the worker before decoded is set.
+	uint8_t *data;
+	enum gs_color_format format;
+	uint32_t width;
+	uint32_t height;
+
+	// Graphics thread only.
+	gs_texture_t *texture;
+} image_mask_t;
+
+extern image_mask_t *image_mask_acquire(const char *path, uint32_t max_width,
+					uint32_t max_height);
+extern void image_mask_release(image_mask_t *mask);
+extern gs_texture_t *image_mask_get_texture(image_mask_t *mask);
+extern void image_mask_cache_shutdown(void);
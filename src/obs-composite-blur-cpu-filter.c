@@ -0,0 +1,643 @@
+#include "obs-composite-blur-cpu-filter.h"
+
+struct obs_source_info obs_composite_blur_cpu = {
+	.id = "obs_composite_blur_cpu",
+	.type = OBS_SOURCE_TYPE_FILTER,
+	.output_flags = OBS_SOURCE_ASYNC_VIDEO,
+	.get_name = composite_blur_cpu_name,
+	.create = composite_blur_cpu_create,
+	.destroy = composite_blur_cpu_destroy,
+	.update = composite_blur_cpu_update,
+	.filter_video = composite_blur_cpu_filter_video,
+	.get_properties = composite_blur_cpu_properties,
+	.get_defaults = composite_blur_cpu_defaults};
+
+// One pool of workers is shared by every CPU filter instance, sized to
+// the machine rather than to the number of filtered sources.
+static pthread_mutex_t cpu_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static thread_pool_t *cpu_pool = NULL;
+static int cpu_pool_refs = 0;
+
+static const char *composite_blur_cpu_name(void *unused)
+{
+	UNUSED_PARAMETER(unused);
+	return obs_module_text("CompositeBlurCpuFilter");
+}
+
+static void *composite_blur_cpu_create(obs_data_t *settings,
+				       obs_source_t *source)
+{
+	composite_blur_cpu_filter_data_t *filter =
+		bzalloc(sizeof(composite_blur_cpu_filter_data_t));
+	filter->context = source;
+	pthread_mutex_init(&filter->settings_mutex, NULL);
+
+	pthread_mutex_lock(&cpu_pool_mutex);
+	if (!cpu_pool) {
+		// The thread running filter_video works on each job too.
+		cpu_pool = thread_pool_create(os_get_logical_cores() - 1);
+	}
+	cpu_pool_refs++;
+	pthread_mutex_unlock(&cpu_pool_mutex);
+
+	obs_source_update(source, settings);
+	return filter;
+}
+
+static void composite_blur_cpu_destroy(void *data)
+{
+	composite_blur_cpu_filter_data_t *filter = data;
+
+	pthread_mutex_lock(&cpu_pool_mutex);
+	if (--cpu_pool_refs == 0) {
+		thread_pool_destroy(cpu_pool);
+		cpu_pool = NULL;
+	}
+	pthread_mutex_unlock(&cpu_pool_mutex);
+
+	pthread_mutex_destroy(&filter->settings_mutex);
+	bfree(filter->original);
+	bfree(filter->temp);
+	bfree(filter->mask);
+	bfree(filter);
+}
+
+static void composite_blur_cpu_update(void *data, obs_data_t *settings)
+{
+	composite_blur_cpu_filter_data_t *filter = data;
+	cpu_blur_settings_t s = {0};
+
+	s.blur_algorithm = (int)obs_data_get_int(settings, "blur_algorithm");
+	s.radius = (float)obs_data_get_double(settings, "radius");
+	s.passes = (int)obs_data_get_int(settings, "passes");
+
+	// Crop and rectangle masks are both reduced to a box in fractions
+	// of the frame, as in apply_effect_mask_crop/rect.
+	s.mask_type = (int)obs_data_get_int(settings, "effect_mask");
+	switch (s.mask_type) {
+	case EFFECT_MASK_TYPE_CROP:
+		s.mask_left = (float)obs_data_get_double(
+				      settings, "effect_mask_crop_left") /
+			      100.0f;
+		s.mask_top = (float)obs_data_get_double(settings,
+							"effect_mask_crop_top") /
+			     100.0f;
+		s.mask_right = (float)obs_data_get_double(
+				       settings, "effect_mask_crop_right") /
+			       100.0f;
+		s.mask_bottom = (float)obs_data_get_double(
+					settings, "effect_mask_crop_bottom") /
+				100.0f;
+		s.mask_feathering = (float)obs_data_get_double(
+					    settings,
+					    "effect_mask_crop_feathering") /
+				    100.0f;
+		s.mask_invert =
+			obs_data_get_bool(settings, "effect_mask_crop_invert");
+		break;
+	case EFFECT_MASK_TYPE_RECT: {
+		const float center_x = (float)obs_data_get_double(
+			settings, "effect_mask_rect_center_x");
+		const float center_y = (float)obs_data_get_double(
+			settings, "effect_mask_rect_center_y");
+		const float width = (float)obs_data_get_double(
+			settings, "effect_mask_rect_width");
+		const float height = (float)obs_data_get_double(
+			settings, "effect_mask_rect_height");
+		s.mask_left = (center_x - width / 2.0f) / 100.0f;
+		s.mask_right = (100.0f - center_x - width / 2.0f) / 100.0f;
+		s.mask_top = (center_y - height / 2.0f) / 100.0f;
+		s.mask_bottom = (100.0f - center_y - height / 2.0f) / 100.0f;
+		s.mask_feathering = (float)obs_data_get_double(
+					    settings,
+					    "effect_mask_rect_feathering") /
+				    100.0f;
+		s.mask_invert =
+			obs_data_get_bool(settings, "effect_mask_rect_invert");
+		break;
+	}
+	case EFFECT_MASK_TYPE_CIRCLE:
+		s.mask_circle_center_x =
+			(float)obs_data_get_double(
+				settings, "effect_mask_circle_center_x") /
+			100.0f;
+		s.mask_circle_center_y =
+			(float)obs_data_get_double(
+				settings, "effect_mask_circle_center_y") /
+			100.0f;
+		s.mask_circle_radius = (float)obs_data_get_double(
+					       settings,
+					       "effect_mask_circle_radius") /
+				       100.0f;
+		s.mask_feathering = (float)obs_data_get_double(
+					    settings,
+					    "effect_mask_circle_feathering") /
+				    100.0f;
+		s.mask_invert = obs_data_get_bool(settings,
+						  "effect_mask_circle_invert");
+		break;
+	default:
+		s.mask_type = EFFECT_MASK_TYPE_NONE;
+	}
+
+	pthread_mutex_lock(&filter->settings_mutex);
+	filter->settings = s;
+	filter->mask_dirty = true;
+	pthread_mutex_unlock(&filter->settings_mutex);
+}
+
+static void composite_blur_cpu_defaults(obs_data_t *settings)
+{
+	obs_data_set_default_int(settings, "blur_algorithm", ALGO_GAUSSIAN);
+	obs_data_set_default_double(settings, "radius", 10.0);
+	obs_data_set_default_int(settings, "passes", 1);
+	obs_data_set_default_int(settings, "effect_mask",
+				 EFFECT_MASK_TYPE_NONE);
+
+	obs_data_set_default_double(settings, "effect_mask_circle_center_x",
+				    50.0);
+	obs_data_set_default_double(settings, "effect_mask_circle_center_y",
+				    50.0);
+	obs_data_set_default_double(settings, "effect_mask_circle_radius",
+				    40.0);
+
+	obs_data_set_default_double(settings, "effect_mask_rect_center_x",
+				    50.0);
+	obs_data_set_default_double(settings, "effect_mask_rect_center_y",
+				    50.0);
+	obs_data_set_default_double(settings, "effect_mask_rect_width", 50.0);
+	obs_data_set_default_double(settings, "effect_mask_rect_height", 50.0);
+
+	obs_data_set_default_double(settings, "effect_mask_crop_top", 20.0);
+	obs_data_set_default_double(settings, "effect_mask_crop_bottom", 20.0);
+	obs_data_set_default_double(settings, "effect_mask_crop_left", 20.0);
+	obs_data_set_default_double(settings, "effect_mask_crop_right", 20.0);
+}
+
+static void setting_visibility(const char *prop_name, bool visible,
+			       obs_properties_t *props)
+{
+	obs_property_t *p = obs_properties_get(props, prop_name);
+	obs_property_set_enabled(p, visible);
+	obs_property_set_visible(p, visible);
+}
+
+static bool setting_cpu_blur_algorithm_modified(obs_properties_t *props,
+						obs_property_t *p,
+						obs_data_t *settings)
+{
+	UNUSED_PARAMETER(p);
+	int blur_algorithm = (int)obs_data_get_int(settings, "blur_algorithm");
+	obs_property_t *radius = obs_properties_get(props, "radius");
+	switch (blur_algorithm) {
+	case ALGO_PIXELATE:
+		setting_visibility("passes", false, props);
+		obs_property_set_description(
+			radius,
+			obs_module_text("CompositeBlurFilter.Pixelate.PixelSize"));
+		obs_property_float_set_limits(radius, 1.0, 1024.01, 0.1);
+		break;
+	case ALGO_BOX:
+		setting_visibility("passes", true, props);
+		obs_property_set_description(
+			radius, obs_module_text("CompositeBlurFilter.Radius"));
+		obs_property_float_set_limits(radius, 0.0, 80.01, 0.1);
+		break;
+	default:
+		setting_visibility("passes", false, props);
+		obs_property_set_description(
+			radius, obs_module_text("CompositeBlurFilter.Radius"));
+		obs_property_float_set_limits(radius, 0.0, 80.01, 0.1);
+	}
+	return true;
+}
+
+static bool setting_cpu_effect_mask_modified(obs_properties_t *props,
+					     obs_property_t *p,
+					     obs_data_t *settings)
+{
+	UNUSED_PARAMETER(p);
+	int mask_type = (int)obs_data_get_int(settings, "effect_mask");
+	setting_visibility("effect_mask_crop",
+			   mask_type == EFFECT_MASK_TYPE_CROP, props);
+	setting_visibility("effect_mask_rect",
+			   mask_type == EFFECT_MASK_TYPE_RECT, props);
+	setting_visibility("effect_mask_circle",
+			   mask_type == EFFECT_MASK_TYPE_CIRCLE, props);
+	return true;
+}
+
+static obs_properties_t *composite_blur_cpu_properties(void *data)
+{
+	UNUSED_PARAMETER(data);
+	obs_properties_t *props = obs_properties_create();
+
+	obs_property_t *blur_algorithms = obs_properties_add_list(
+		props, "blur_algorithm",
+		obs_module_text("CompositeBlurFilter.BlurAlgorithm"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(blur_algorithms,
+				  obs_module_text(ALGO_GAUSSIAN_LABEL),
+				  ALGO_GAUSSIAN);
+	obs_property_list_add_int(blur_algorithms,
+				  obs_module_text(ALGO_BOX_LABEL), ALGO_BOX);
+	obs_property_list_add_int(blur_algorithms,
+				  obs_module_text(ALGO_PIXELATE_LABEL),
+				  ALGO_PIXELATE);
+	obs_property_set_modified_callback(blur_algorithms,
+					   setting_cpu_blur_algorithm_modified);
+
+	obs_property_t *p = obs_properties_add_float_slider(
+		props, "radius", obs_module_text("CompositeBlurFilter.Radius"),
+		0.0, 80.01, 0.1);
+	obs_property_float_set_suffix(p, "px");
+
+	obs_properties_add_int_slider(
+		props, "passes",
+		obs_module_text("CompositeBlurFilter.Box.Passes"), 1, 5, 1);
+
+	obs_property_t *effect_mask_list = obs_properties_add_list(
+		props, "effect_mask",
+		obs_module_text("CompositeBlurFilter.EffectMask"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(effect_mask_list,
+				  obs_module_text(EFFECT_MASK_TYPE_NONE_LABEL),
+				  EFFECT_MASK_TYPE_NONE);
+	obs_property_list_add_int(effect_mask_list,
+				  obs_module_text(EFFECT_MASK_TYPE_CROP_LABEL),
+				  EFFECT_MASK_TYPE_CROP);
+	obs_property_list_add_int(effect_mask_list,
+				  obs_module_text(EFFECT_MASK_TYPE_RECT_LABEL),
+				  EFFECT_MASK_TYPE_RECT);
+	obs_property_list_add_int(
+		effect_mask_list,
+		obs_module_text(EFFECT_MASK_TYPE_CIRCLE_LABEL),
+		EFFECT_MASK_TYPE_CIRCLE);
+	obs_property_set_modified_callback(effect_mask_list,
+					   setting_cpu_effect_mask_modified);
+
+	obs_properties_t *effect_mask_crop = obs_properties_create();
+	obs_properties_add_float_slider(
+		effect_mask_crop, "effect_mask_crop_top",
+		obs_module_text("CompositeBlurFilter.EffectMask.Crop.Top"), 0.0,
+		100.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_crop, "effect_mask_crop_bottom",
+		obs_module_text("CompositeBlurFilter.EffectMask.Crop.Bottom"),
+		0.0, 100.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_crop, "effect_mask_crop_left",
+		obs_module_text("CompositeBlurFilter.EffectMask.Crop.Left"),
+		0.0, 100.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_crop, "effect_mask_crop_right",
+		obs_module_text("CompositeBlurFilter.EffectMask.Crop.Right"),
+		0.0, 100.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_crop, "effect_mask_crop_feathering",
+		obs_module_text("CompositeBlurFilter.EffectMask.Feathering"),
+		0.0, 100.01, 0.01);
+	obs_properties_add_bool(
+		effect_mask_crop, "effect_mask_crop_invert",
+		obs_module_text("CompositeBlurFilter.EffectMask.Invert"));
+	obs_properties_add_group(
+		props, "effect_mask_crop",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.CropParameters"),
+		OBS_GROUP_NORMAL, effect_mask_crop);
+
+	obs_properties_t *effect_mask_rect = obs_properties_create();
+	obs_properties_add_float_slider(
+		effect_mask_rect, "effect_mask_rect_center_x",
+		obs_module_text("CompositeBlurFilter.EffectMask.Rect.CenterX"),
+		-500.01, 600.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_rect, "effect_mask_rect_center_y",
+		obs_module_text("CompositeBlurFilter.EffectMask.Rect.CenterY"),
+		-500.01, 600.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_rect, "effect_mask_rect_width",
+		obs_module_text("CompositeBlurFilter.EffectMask.Rect.Width"),
+		0.0, 500.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_rect, "effect_mask_rect_height",
+		obs_module_text("CompositeBlurFilter.EffectMask.Rect.Height"),
+		0.0, 500.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_rect, "effect_mask_rect_feathering",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.Rect.Feathering"),
+		0.0, 100.01, 0.01);
+	obs_properties_add_bool(
+		effect_mask_rect, "effect_mask_rect_invert",
+		obs_module_text("CompositeBlurFilter.EffectMask.Invert"));
+	obs_properties_add_group(
+		props, "effect_mask_rect",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.RectParameters"),
+		OBS_GROUP_NORMAL, effect_mask_rect);
+
+	obs_properties_t *effect_mask_circle = obs_properties_create();
+	obs_properties_add_float_slider(
+		effect_mask_circle, "effect_mask_circle_center_x",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.Circle.CenterX"),
+		-500.01, 600.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_circle, "effect_mask_circle_center_y",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.Circle.CenterY"),
+		-500.01, 600.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_circle, "effect_mask_circle_radius",
+		obs_module_text("CompositeBlurFilter.EffectMask.Circle.Radius"),
+		0.0, 500.01, 0.01);
+	obs_properties_add_float_slider(
+		effect_mask_circle, "effect_mask_circle_feathering",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.Circle.Feathering"),
+		0.0, 100.01, 0.01);
+	obs_properties_add_bool(
+		effect_mask_circle, "effect_mask_circle_invert",
+		obs_module_text("CompositeBlurFilter.EffectMask.Invert"));
+	obs_properties_add_group(
+		props, "effect_mask_circle",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.CircleParameters"),
+		OBS_GROUP_NORMAL, effect_mask_circle);
+
+	obs_properties_add_text(props, "plugin_info", PLUGIN_INFO,
+				OBS_TEXT_INFO);
+
+	return props;
+}
+
+static void set_plane(cpu_plane_t *plane, const struct obs_source_frame *frame,
+		      int index, uint32_t width, uint32_t height,
+		      uint32_t channels)
+{
+	plane->data = frame->data[index];
+	plane->linesize = frame->linesize[index];
+	plane->width = width;
+	plane->height = height;
+	plane->channels = channels;
+}
+
+/*
+ *  Describes the planes of frame, with each plane's subsampling
+ *  relative to the first as shifts. Returns 0 for formats the CPU
+ *  blurs don't handle, e.g. packed 4:2:2 or more than 8 bits.
+ */
+static int frame_planes(const struct obs_source_frame *frame,
+			cpu_plane_t *planes, uint32_t *shift_x,
+			uint32_t *shift_y)
+{
+	const uint32_t w = frame->width;
+	const uint32_t h = frame->height;
+	const uint32_t half_w = (w + 1) / 2;
+	const uint32_t half_h = (h + 1) / 2;
+
+	memset(shift_x, 0, sizeof(uint32_t) * CPU_MAX_PLANES);
+	memset(shift_y, 0, sizeof(uint32_t) * CPU_MAX_PLANES);
+
+	switch (frame->format) {
+	case VIDEO_FORMAT_Y800:
+		set_plane(&planes[0], frame, 0, w, h, 1);
+		return 1;
+	case VIDEO_FORMAT_RGBA:
+	case VIDEO_FORMAT_BGRA:
+	case VIDEO_FORMAT_BGRX:
+	case VIDEO_FORMAT_AYUV:
+		set_plane(&planes[0], frame, 0, w, h, 4);
+		return 1;
+	case VIDEO_FORMAT_BGR3:
+		set_plane(&planes[0], frame, 0, w, h, 3);
+		return 1;
+	case VIDEO_FORMAT_NV12:
+		set_plane(&planes[0], frame, 0, w, h, 1);
+		set_plane(&planes[1], frame, 1, half_w, half_h, 2);
+		shift_x[1] = shift_y[1] = 1;
+		return 2;
+	case VIDEO_FORMAT_I420:
+	case VIDEO_FORMAT_I40A:
+		set_plane(&planes[0], frame, 0, w, h, 1);
+		set_plane(&planes[1], frame, 1, half_w, half_h, 1);
+		set_plane(&planes[2], frame, 2, half_w, half_h, 1);
+		shift_x[1] = shift_y[1] = shift_x[2] = shift_y[2] = 1;
+		if (frame->format == VIDEO_FORMAT_I40A) {
+			set_plane(&planes[3], frame, 3, w, h, 1);
+			return 4;
+		}
+		return 3;
+	case VIDEO_FORMAT_I422:
+	case VIDEO_FORMAT_I42A:
+		set_plane(&planes[0], frame, 0, w, h, 1);
+		set_plane(&planes[1], frame, 1, half_w, h, 1);
+		set_plane(&planes[2], frame, 2, half_w, h, 1);
+		shift_x[1] = shift_x[2] = 1;
+		if (frame->format == VIDEO_FORMAT_I42A) {
+			set_plane(&planes[3], frame, 3, w, h, 1);
+			return 4;
+		}
+		return 3;
+	case VIDEO_FORMAT_I444:
+	case VIDEO_FORMAT_YUVA:
+		set_plane(&planes[0], frame, 0, w, h, 1);
+		set_plane(&planes[1], frame, 1, w, h, 1);
+		set_plane(&planes[2], frame, 2, w, h, 1);
+		if (frame->format == VIDEO_FORMAT_YUVA) {
+			set_plane(&planes[3], frame, 3, w, h, 1);
+			return 4;
+		}
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+/*
+ *  Finds alpha at the resolution of every color plane: byte 3 of
+ *  packed RGBA, BGRA and AYUV, or the fourth plane of YUVA. Returns the
+ *  plane holding it, or -1. I40A and I42A are blurred as straight
+ *  alpha, since their chroma is subsampled against it.
+ */
+static int frame_alpha_plane(const struct obs_source_frame *frame,
+			     uint32_t *channel)
+{
+	switch (frame->format) {
+	case VIDEO_FORMAT_RGBA:
+	case VIDEO_FORMAT_BGRA:
+	case VIDEO_FORMAT_AYUV:
+		*channel = 3;
+		return 0;
+	case VIDEO_FORMAT_YUVA:
+		*channel = 0;
+		return 3;
+	default:
+		return -1;
+	}
+}
+
+// Rebuilds the mask when its settings or the frame size changed.
+static void update_mask(composite_blur_cpu_filter_data_t *filter,
+			const cpu_blur_settings_t *s, uint32_t width,
+			uint32_t height)
+{
+	if (!filter->mask_stale && filter->mask && filter->mask_width == width &&
+	    filter->mask_height == height) {
+		return;
+	}
+	if (filter->mask_width != width || filter->mask_height != height ||
+	    !filter->mask) {
+		bfree(filter->mask);
+		filter->mask = bmalloc((size_t)width * height);
+		filter->mask_width = width;
+		filter->mask_height = height;
+	}
+	if (s->mask_type == EFFECT_MASK_TYPE_CIRCLE) {
+		cpu_mask_circle(filter->mask, width, height,
+				s->mask_circle_center_x,
+				s->mask_circle_center_y, s->mask_circle_radius,
+				s->mask_feathering, s->mask_invert);
+	} else {
+		cpu_mask_box(filter->mask, width, height, s->mask_left,
+			     s->mask_top, s->mask_right, s->mask_bottom,
+			     s->mask_feathering, s->mask_invert);
+	}
+	filter->mask_stale = false;
+}
+
+static void blur_plane(const cpu_blur_settings_t *s, const cpu_plane_t *src,
+		       cpu_plane_t *dst, uint8_t *temp, uint32_t shift_x,
+		       uint32_t shift_y)
+{
+	const float scale_x = 1.0f / (float)(1 << shift_x);
+	const float scale_y = 1.0f / (float)(1 << shift_y);
+
+	switch (s->blur_algorithm) {
+	case ALGO_BOX: {
+		const int radius_x = (int)(s->radius * scale_x + 0.5f);
+		const int radius_y = (int)(s->radius * scale_y + 0.5f);
+		cpu_blur_box(cpu_pool, src, dst, temp, radius_x, radius_y,
+			     s->passes);
+		break;
+	}
+	case ALGO_PIXELATE: {
+		const uint32_t cell_x = (uint32_t)(s->radius * scale_x + 0.5f);
+		const uint32_t cell_y = (uint32_t)(s->radius * scale_y + 0.5f);
+		cpu_pixelate(cpu_pool, src, dst, cell_x, cell_y);
+		break;
+	}
+	default:
+		cpu_blur_gaussian(cpu_pool, src, dst, temp, s->radius * scale_x,
+				  s->radius * scale_y);
+	}
+}
+
+/*
+ *  Blurs the frame in place, one plane at a time. Each plane is copied
+ *  aside first, as the source of the blur and, with a mask, of the
+ *  unblurred pixels mixed back in. Frames with translucent pixels are
+ *  premultiplied for the blur and converted back to straight alpha
+ *  after it.
+ */
+static struct obs_source_frame *
+composite_blur_cpu_filter_video(void *data, struct obs_source_frame *frame)
+{
+	composite_blur_cpu_filter_data_t *filter = data;
+
+	pthread_mutex_lock(&filter->settings_mutex);
+	const cpu_blur_settings_t s = filter->settings;
+	filter->mask_stale = filter->mask_stale || filter->mask_dirty;
+	filter->mask_dirty = false;
+	pthread_mutex_unlock(&filter->settings_mutex);
+
+	const float min_radius = s.blur_algorithm == ALGO_PIXELATE ? 1.5f
+								   : 0.1f;
+	if (s.radius < min_radius || !frame || !frame->width ||
+	    !frame->height) {
+		return frame;
+	}
+
+	cpu_plane_t planes[CPU_MAX_PLANES];
+	uint32_t shift_x[CPU_MAX_PLANES];
+	uint32_t shift_y[CPU_MAX_PLANES];
+	const int plane_count = frame_planes(frame, planes, shift_x, shift_y);
+	if (plane_count == 0) {
+		if (filter->unsupported_format != frame->format) {
+			filter->unsupported_format = frame->format;
+			blog(LOG_WARNING,
+			     "[Composite Blur] CPU blur does not support "
+			     "video format %d, frames pass through",
+			     (int)frame->format);
+		}
+		return frame;
+	}
+	filter->unsupported_format = VIDEO_FORMAT_NONE;
+
+	size_t size = 0;
+	for (int i = 0; i < plane_count; i++) {
+		const size_t bytes = (size_t)planes[i].width *
+				     planes[i].channels * planes[i].height;
+		size = bytes > size ? bytes : size;
+	}
+	if (size > filter->buffer_size) {
+		bfree(filter->original);
+		bfree(filter->temp);
+		filter->original = bmalloc(size);
+		filter->temp = bmalloc(size);
+		filter->buffer_size = size;
+	}
+
+	const bool masked = s.mask_type != EFFECT_MASK_TYPE_NONE;
+	if (masked) {
+		update_mask(filter, &s, planes[0].width, planes[0].height);
+	}
+
+	uint32_t alpha_channel = 0;
+	const int alpha_plane = frame_alpha_plane(frame, &alpha_channel);
+	const bool premultiply =
+		alpha_plane >= 0 &&
+		!cpu_alpha_opaque(&planes[alpha_plane], alpha_channel);
+	// Packed formats hold color and alpha in the one plane.
+	const int color_planes = alpha_plane > 0 ? alpha_plane : 1;
+	if (premultiply) {
+		for (int i = 0; i < color_planes; i++) {
+			cpu_premultiply(cpu_pool, &planes[i],
+					&planes[alpha_plane], alpha_channel,
+					false);
+		}
+	}
+
+	for (int i = 0; i < plane_count; i++) {
+		cpu_plane_t *plane = &planes[i];
+		cpu_plane_t original = {filter->original,
+					plane->width * plane->channels,
+					plane->width, plane->height,
+					plane->channels};
+		for (uint32_t y = 0; y < plane->height; y++) {
+			memcpy(original.data + (size_t)y * original.linesize,
+			       plane->data + (size_t)y * plane->linesize,
+			       original.linesize);
+		}
+
+		blur_plane(&s, &original, plane, filter->temp, shift_x[i],
+			   shift_y[i]);
+		if (masked) {
+			cpu_blend_mask(cpu_pool, &original, plane,
+				       filter->mask, filter->mask_width,
+				       filter->mask_height, shift_x[i],
+				       shift_y[i]);
+		}
+	}
+
+	if (premultiply) {
+		for (int i = 0; i < color_planes; i++) {
+			cpu_premultiply(cpu_pool, &planes[i],
+					&planes[alpha_plane], alpha_channel,
+					true);
+		}
+	}
+
+	return frame;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <obs-module.h>
+#include <util/threading.h>
+
+#include "obs-composite-blur-filter.h"
+#include "thread-pool.h"
+#include "blur/cpu_blur.h"
+
+// Planes of the largest supported frame format (I40A, I42A, YUVA).
+#define CPU_MAX_PLANES 4
+
+// Settings read by the video thread, copied under settings_mutex.
+typedef struct cpu_blur_settings {
+	int blur_algorithm;
+	float radius;
+	int passes;
+
+	int mask_type;
+	float mask_left;
+	float mask_top;
+	float mask_right;
+	float mask_bottom;
+	float mask_circle_center_x;
+	float mask_circle_center_y;
+	float mask_circle_radius;
+	float mask_feathering;
+	bool mask_invert;
+} cpu_blur_settings_t;
+
+typedef struct composite_blur_cpu_filter_data {
+	obs_source_t *context;
+
+	pthread_mutex_t settings_mutex;
+	cpu_blur_settings_t settings;
+	bool mask_dirty;
+
+	// Video thread only. Buffers grow to the largest plane seen.
+	uint8_t *original;
+	uint8_t *temp;
+	size_t buffer_size;
+	uint8_t *mask;
+	bool mask_stale;
+	uint32_t mask_width;
+	uint32_t mask_height;
+	enum video_format unsupported_format;
+} composite_blur_cpu_filter_data_t;
+
+static const char *composite_blur_cpu_name(void *type_data);
+static void *composite_blur_cpu_create(obs_data_t *settings,
+				       obs_source_t *source);
+static void composite_blur_cpu_destroy(void *data);
+static void composite_blur_cpu_update(void *data, obs_data_t *settings);
+static void composite_blur_cpu_defaults(obs_data_t *settings);
+static obs_properties_t *composite_blur_cpu_properties(void *data);
+static struct obs_source_frame *
+composite_blur_cpu_filter_video(void *data, struct obs_source_frame *frame);
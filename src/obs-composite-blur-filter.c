@@ -22,6 +22,15 @@ struct obs_source_info obs_composite_blur = {
 	.get_properties = composite_blur_properties,
 	.get_defaults = composite_blur_defaults};
 
+// GPU memory held by all instances, and the optional budget shared by
+// every instance. The scalable totals only count instances whose
+// algorithm honours the processing scale. Guarded by vram_mutex.
+static pthread_mutex_t vram_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t vram_global_total = 0;
+static uint64_t vram_global_budget = 0;
+static uint64_t vram_scalable_total = 0;
+static int vram_scalable_instances = 0;
+
 static const char *composite_blur_name(void *unused)
 {
 	UNUSED_PARAMETER(unused);
@@ -37,11 +46,19 @@ static void composite_blur_defaults(obs_data_t *settings)
 		obs_module_text("CompositeBlurFilter.Background.None"));
 	obs_data_set_default_int(settings, "passes", 1);
 	obs_data_set_default_int(settings, "kawase_passes", 10);
+	obs_data_set_default_int(settings, "processing_scale",
+				 PROCESSING_SCALE_FULL);
+	obs_data_set_default_int(settings, "idle_release_time",
+				 IDLE_RELEASE_DEFAULT);
+	obs_data_set_default_int(settings, "vector_gradient_scale",
+				 PROCESSING_SCALE_FULL);
 	obs_data_set_default_string(
 		settings, "effect_mask_source_source",
 		obs_module_text("CompositeBlurFilter.EffectMask.Source.None"));
 	obs_data_set_default_double(
 		settings, "effect_mask_source_filter_multiplier", 1.0);
+	obs_data_set_default_int(settings, "effect_mask_source_scale",
+				 PROCESSING_SCALE_FULL);
 	obs_data_set_default_double(settings, "pixelate_origin_x", -1.e9);
 	obs_data_set_default_double(settings, "pixelate_origin_y", -1.e9);
 	obs_data_set_default_double(settings, "pixelate_animation_speed", 50.0);
@@ -66,6 +83,11 @@ static void composite_blur_defaults(obs_data_t *settings)
 	obs_data_set_default_string(settings, "vector_source", "");
 	obs_data_set_default_double(settings, "temporal_current_weight", 0.95);
 	obs_data_set_default_double(settings, "temporal_clear_threshold", 5.0);
+	obs_data_set_default_int(settings, "temporal_mode",
+				 TEMPORAL_MODE_EXPONENTIAL);
+	obs_data_set_default_int(settings, "temporal_frames", 8);
+	obs_data_set_default_int(settings, "temporal_history_scale",
+				 PROCESSING_SCALE_FULL);
 
 }
 
@@ -76,16 +98,30 @@ static void *composite_blur_create(obs_data_t *settings, obs_source_t *source)
 	dstr_init_copy(&filter->filter_name, "");
 	dstr_init_copy(&filter->mask_source_name, "");
 	dstr_init_copy(&filter->background_source_name, "");
+	dstr_init_copy(&filter->mask_image_path, "");
+	dstr_init_copy(&filter->mask_regions_invalid, "");
 
 	filter->context = source;
 	signal_handler_t *sh = obs_source_get_signal_handler(filter->context);
 	signal_handler_connect_ref(sh, "rename", composite_blur_rename, filter);
+	// Named mask and background sources are re-resolved after global
+	// source signals, so the video tick only searches by name when a
+	// source was created, renamed or destroyed.
+	signal_handler_t *obs_sh = obs_get_signal_handler();
+	signal_handler_connect(obs_sh, "source_create",
+			       composite_blur_sources_changed, filter);
+	signal_handler_connect(obs_sh, "source_rename",
+			       composite_blur_sources_changed, filter);
+	signal_handler_connect(obs_sh, "source_destroy",
+			       composite_blur_sources_changed, filter);
 	filter->hotkey = OBS_INVALID_HOTKEY_PAIR_ID;
 	filter->radius = 0.0f;
 	filter->inactive_radius = 0.0f;
 	filter->radius_last = -1.0f;
 	filter->time = 0.0f;
 	filter->angle = 0.0f;
+	filter->log_step = false;
+	filter->log_step_passes = 0;
 	filter->passes = 1;
 	filter->center_x = 0.0f;
 	filter->center_y = 0.0f;
@@ -102,6 +138,13 @@ static void *composite_blur_create(obs_data_t *settings, obs_source_t *source)
 	filter->kernel_texture = NULL;
 	filter->pixelate_type = 1;
 	filter->pixelate_type_last = -1;
+	filter->processing_scale_setting = PROCESSING_SCALE_FULL;
+	filter->processing_scale = 1;
+	filter->vector_gradient_scale = 1;
+	filter->vector_blur_source = NULL;
+	filter->vector_source_static = false;
+	filter->vb_gradient_dirty = true;
+	filter->vb_source_render = NULL;
 
 	filter->temporal_prior_stored = false;
 
@@ -111,9 +154,8 @@ static void *composite_blur_create(obs_data_t *settings, obs_source_t *source)
 	filter->param_uv_size = NULL;
 	filter->param_radius = NULL;
 	filter->param_texel_step = NULL;
+	filter->param_log_step_texel_step = NULL;
 	filter->param_kernel_size = NULL;
-	filter->param_offset = NULL;
-	filter->param_weight = NULL;
 	filter->param_kernel_texture = NULL;
 	filter->param_radial_center = NULL;
 	filter->param_focus_width = NULL;
@@ -128,6 +170,12 @@ static void *composite_blur_create(obs_data_t *settings, obs_source_t *source)
 	filter->param_pixel_sin_theta = NULL;
 	filter->param_pixel_cos_rtheta = NULL;
 	filter->param_pixel_sin_rtheta = NULL;
+	filter->param_pixel_image_lod = NULL;
+	filter->param_pixel_lod_mix = NULL;
+	filter->param_pixel_seed_map = NULL;
+	filter->voronoi_seed_map_valid = false;
+	filter->param_pixel_cell_map = NULL;
+	filter->pixelate_cell_map_valid = false;
 	filter->param_mask_crop_scale = NULL;
 	filter->param_mask_crop_offset = NULL;
 	filter->param_mask_crop_box_aspect_ratio = NULL;
@@ -143,10 +191,21 @@ static void *composite_blur_create(obs_data_t *settings, obs_source_t *source)
 	filter->param_mask_circle_feathering = NULL;
 	filter->param_mask_circle_inv = NULL;
 	filter->param_mask_circle_uv_scale = NULL;
+	filter->param_mask_regions_uv_scale = NULL;
+	filter->param_mask_regions_shape = NULL;
+	filter->param_mask_regions_params = NULL;
+	filter->param_mask_regions_count = NULL;
+	filter->param_mask_regions_inv = NULL;
 	filter->param_temporal_image = NULL;
 	filter->param_temporal_prior_image = NULL;
 	filter->param_temporal_current_weight = NULL;
 	filter->param_temporal_clear_threshold = NULL;
+	filter->param_temporal_sum_image = NULL;
+	filter->param_temporal_oldest_image = NULL;
+	filter->param_temporal_sum_weight = NULL;
+	filter->param_temporal_oldest_weight = NULL;
+	filter->param_temporal_frame_count = NULL;
+	filter->param_temporal_store_offset = NULL;
 
 	filter->mask_image = NULL;
 
@@ -170,6 +229,10 @@ static void *composite_blur_create(obs_data_t *settings, obs_source_t *source)
 	filter->mask_source_invert = false;
 
 	filter->param_output_image = NULL;
+	filter->param_output_linear = NULL;
+	filter->param_resample_source_size = NULL;
+	filter->param_resample_scale = NULL;
+	filter->param_gradient_scale = NULL;
 
 	da_init(filter->kernel);
 	//composite_blur_defaults(settings);
@@ -189,10 +252,27 @@ static void composite_blur_destroy(void *data)
 
 	signal_handler_t *sh = obs_source_get_signal_handler(filter->context);
 	signal_handler_disconnect(sh, "rename", composite_blur_rename, filter);
+	signal_handler_t *obs_sh = obs_get_signal_handler();
+	signal_handler_disconnect(obs_sh, "source_create",
+				  composite_blur_sources_changed, filter);
+	signal_handler_disconnect(obs_sh, "source_rename",
+				  composite_blur_sources_changed, filter);
+	signal_handler_disconnect(obs_sh, "source_destroy",
+				  composite_blur_sources_changed, filter);
 
 	dstr_free(&filter->filter_name);
 	dstr_free(&filter->mask_source_name);
 	dstr_free(&filter->background_source_name);
+	dstr_free(&filter->mask_image_path);
+	dstr_free(&filter->mask_regions_invalid);
+
+	pthread_mutex_lock(&vram_mutex);
+	vram_global_total -= filter->vram_total;
+	if (filter->vram_scalable) {
+		vram_scalable_instances--;
+		vram_scalable_total -= filter->vram_total;
+	}
+	pthread_mutex_unlock(&vram_mutex);
 
 	obs_enter_graphics();
 	if (filter->effect) {
@@ -213,6 +293,12 @@ static void composite_blur_destroy(void *data)
 	if (filter->pixelate_effect) {
 		gs_effect_destroy(filter->pixelate_effect);
 	}
+	if (filter->pixelate_cells_effect) {
+		gs_effect_destroy(filter->pixelate_cells_effect);
+	}
+	if (filter->voronoi_jfa_effect) {
+		gs_effect_destroy(filter->voronoi_jfa_effect);
+	}
 	if (filter->output_effect) {
 		gs_effect_destroy(filter->output_effect);
 	}
@@ -222,6 +308,27 @@ static void composite_blur_destroy(void *data)
 	if (filter->gv_effect) {
 		gs_effect_destroy(filter->gv_effect);
 	}
+	if (filter->resample_effect) {
+		gs_effect_destroy(filter->resample_effect);
+	}
+	if (filter->stencil_effect) {
+		gs_effect_destroy(filter->stencil_effect);
+	}
+	if (filter->stencil_zs) {
+		gs_zstencil_destroy(filter->stencil_zs);
+	}
+	if (filter->stencil_target) {
+		gs_texrender_destroy(filter->stencil_target);
+	}
+	if (filter->stencil_coverage) {
+		gs_texrender_destroy(filter->stencil_coverage);
+	}
+	if (filter->stencil_zero) {
+		gs_texrender_destroy(filter->stencil_zero);
+	}
+	if (filter->stencil_one) {
+		gs_texrender_destroy(filter->stencil_one);
+	}
 
 	if (filter->render) {
 		gs_texrender_destroy(filter->render);
@@ -241,17 +348,35 @@ static void composite_blur_destroy(void *data)
 	if (filter->composite_render) {
 		gs_texrender_destroy(filter->composite_render);
 	}
-	if (filter->pixelate_texrender) {
-		gs_texrender_destroy(filter->pixelate_texrender);
+	if (filter->pixelate_cells_texrender) {
+		gs_texrender_destroy(filter->pixelate_cells_texrender);
+	}
+	if (filter->voronoi_seed_map) {
+		gs_texrender_destroy(filter->voronoi_seed_map);
+	}
+	if (filter->voronoi_seed_map2) {
+		gs_texrender_destroy(filter->voronoi_seed_map2);
 	}
+	if (filter->pixelate_cell_map) {
+		gs_texrender_destroy(filter->pixelate_cell_map);
+	}
+	temporal_free_history(filter);
+	if (filter->processing_input_texrender) {
+		gs_texrender_destroy(filter->processing_input_texrender);
+	}
+	render_pool_free(&filter->graph_pool);
+	if (filter->vb_smoothed_gradient) {
+		gs_texrender_destroy(filter->vb_smoothed_gradient);
+	}
+	if (filter->vb_source_render) {
+		gs_texrender_destroy(filter->vb_source_render);
+	}
+	pyramid_cache_free(filter->pyramids);
 
 	if (filter->kernel_texture) {
 		gs_texture_destroy(filter->kernel_texture);
 	}
-	if (filter->mask_image) {
-		gs_image_file_free(filter->mask_image);
-		bfree(filter->mask_image);
-	}
+	image_mask_release(filter->mask_image);
 
 	if (filter->background) {
 		obs_weak_source_release(filter->background);
@@ -260,6 +385,14 @@ static void composite_blur_destroy(void *data)
 	if (filter->mask_source_source) {
 		obs_weak_source_release(filter->mask_source_source);
 	}
+	if (filter->mask_source_render) {
+		gs_texrender_destroy(filter->mask_source_render);
+	}
+	if (filter->mask_channel_render) {
+		gs_texrender_destroy(filter->mask_channel_render);
+	}
+
+	vector_blur_set_source(filter, NULL);
 
 	if (filter->hotkey != OBS_INVALID_HOTKEY_PAIR_ID) {
 		obs_hotkey_pair_unregister(filter->hotkey);
@@ -275,13 +408,13 @@ static void composite_blur_destroy(void *data)
 static uint32_t composite_blur_width(void *data)
 {
 	struct composite_blur_filter_data *filter = data;
-	return filter->width;
+	return filter->full_width;
 }
 
 static uint32_t composite_blur_height(void *data)
 {
 	struct composite_blur_filter_data *filter = data;
-	return filter->height;
+	return filter->full_height;
 }
 
 static void composite_blur_rename(void *data, calldata_t *call_data)
@@ -306,6 +439,52 @@ static void composite_blur_rename(void *data, calldata_t *call_data)
 	dstr_free(&disable);
 }
 
+/*
+ *  Source signals arrive on the thread that created, renamed or
+ *  destroyed the source, while the references are read when rendering.
+ *  Only flag the change here, composite_blur_video_tick resolves it.
+ */
+static void composite_blur_sources_changed(void *data, calldata_t *call_data)
+{
+	UNUSED_PARAMETER(call_data);
+	composite_blur_filter_data_t *filter = data;
+	os_atomic_store_bool(&filter->sources_dirty, true);
+}
+
+/*
+ *  Video thread only. Drops a reference to a destroyed source, resolves
+ *  an unresolved name once a source with that name exists, and follows
+ *  renames of the referenced source, keeping the stored name and the
+ *  setting in sync.
+ */
+static void sync_named_source(composite_blur_filter_data_t *filter,
+			      obs_weak_source_t **weak, bool has_source,
+			      struct dstr *name, const char *setting)
+{
+	if (!has_source) {
+		return;
+	}
+	obs_source_t *source = *weak ? obs_weak_source_get_source(*weak)
+				     : NULL;
+	if (*weak && !source) {
+		obs_weak_source_release(*weak);
+		*weak = NULL;
+	}
+
+	if (!source) {
+		source = obs_get_source_by_name(name->array);
+		if (source) {
+			*weak = obs_source_get_weak_source(source);
+		}
+	} else if (strcmp(obs_source_get_name(source), name->array) != 0) {
+		dstr_copy(name, obs_source_get_name(source));
+		obs_data_t *settings = obs_source_get_settings(filter->context);
+		obs_data_set_string(settings, setting, name->array);
+		obs_data_release(settings);
+	}
+	obs_source_release(source);
+}
+
 static void composite_blur_update(void *data, obs_data_t *settings)
 {
 	struct composite_blur_filter_data *filter = data;
@@ -333,6 +512,23 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 
 	filter->temporal_clear_threshold = (float)obs_data_get_double(settings, "temporal_clear_threshold") / 100.0f;
 
+	const int temporal_mode =
+		(int)obs_data_get_int(settings, "temporal_mode");
+	const int temporal_frames =
+		(int)obs_data_get_int(settings, "temporal_frames");
+	const int temporal_history_scale =
+		(int)obs_data_get_int(settings, "temporal_history_scale");
+	if (temporal_mode != filter->temporal_mode ||
+	    temporal_frames != filter->temporal_frames ||
+	    temporal_history_scale != filter->temporal_history_scale) {
+		filter->temporal_mode = temporal_mode;
+		filter->temporal_frames = temporal_frames;
+		filter->temporal_history_scale = temporal_history_scale;
+		obs_enter_graphics();
+		temporal_reset_history(filter);
+		obs_leave_graphics();
+	}
+
 	if (filter->pixelate_type != filter->pixelate_type_last) {
 		filter->pixelate_type_last = filter->pixelate_type;
 		filter->reload = true;
@@ -340,10 +536,16 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 
 	filter->pixelate_smoothing_pct =
 		(float)obs_data_get_double(settings, "pixelate_smoothing_pct");
+	filter->pixelate_cell_average =
+		obs_data_get_bool(settings, "pixelate_cell_average");
 
 
 	filter->pixelate_tessel_center.x = (float)obs_data_get_double(settings, "pixelate_origin_x");
 	filter->pixelate_tessel_center.y = (float)obs_data_get_double(settings, "pixelate_origin_y");
+	// Defaults to -1e9 until the first tick with a known size places
+	// the origin at the center.
+	filter->pixelate_origin_set =
+		obs_data_get_double(settings, "pixelate_origin_x") >= -1.e8;
 
 	filter->pixelate_animate = obs_data_get_bool(settings, "pixelate_animate");
 	filter->pixelate_animation_speed = (float)obs_data_get_double(settings, "pixelate_animation_speed")/100.0f;
@@ -442,17 +644,15 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 	const char *mask_image_file =
 		obs_data_get_string(settings, "effect_mask_source_file");
 
-	if (filter->mask_image == NULL) {
-		filter->mask_image = bzalloc(sizeof(gs_image_file_t));
-	} else {
-		obs_enter_graphics();
-		gs_image_file_free(filter->mask_image);
-		obs_leave_graphics();
-	}
-	if (strlen(mask_image_file)) {
-		gs_image_file_init(filter->mask_image, mask_image_file);
+	// Decoding happens on a worker thread once the next frame knows the
+	// filter size, see mask_image_texture. The path and mask are read
+	// while rendering, so they are swapped under the graphics lock.
+	if (strcmp(filter->mask_image_path.array, mask_image_file) != 0) {
 		obs_enter_graphics();
-		gs_image_file_init_texture(filter->mask_image);
+		dstr_copy(&filter->mask_image_path, mask_image_file);
+		image_mask_release(filter->mask_image);
+		filter->mask_image = NULL;
+		filter->mask_image_texture = NULL;
 		obs_leave_graphics();
 	}
 	filter->mask_source_multiplier = (float)obs_data_get_double(
@@ -460,6 +660,12 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 
 	filter->mask_source_invert =
 		obs_data_get_bool(settings, "effect_mask_source_invert");
+	filter->mask_source_scale =
+		(int)obs_data_get_int(settings, "effect_mask_source_scale");
+	filter->mask_source_static =
+		obs_data_get_bool(settings, "effect_mask_source_static");
+	filter->mask_channel_dirty = true;
+	filter->stencil_valid = false;
 
 	filter->mask_circle_center_x = (float)obs_data_get_double(
 		settings, "effect_mask_circle_center_x");
@@ -487,16 +693,34 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 	filter->mask_rect_inv =
 		obs_data_get_bool(settings, "effect_mask_rect_invert");
 
-	filter->radius = (float)obs_data_get_double(settings, "radius");
-	filter->passes = (int)obs_data_get_int(settings, "passes");
-	filter->kawase_passes =
-		(float)obs_data_get_double(settings, "kawase_passes");
+	filter->mask_regions_inv =
+		obs_data_get_bool(settings, "effect_mask_regions_invert");
+	struct dstr invalid_regions = {0};
+	filter->mask_region_count = parse_mask_regions(
+		settings, filter->mask_regions, &invalid_regions);
+	// dstr leaves array NULL for empty strings.
+	const char *invalid_text =
+		invalid_regions.array ? invalid_regions.array : "";
+	const char *logged_text = filter->mask_regions_invalid.array
+					  ? filter->mask_regions_invalid.array
+					  : "";
+	if (*invalid_text && strcmp(invalid_text, logged_text) != 0) {
+		blog(LOG_WARNING,
+		     "[Composite Blur] '%s' ignores mask regions it can't "
+		     "parse:\n%s",
+		     obs_source_get_name(filter->context), invalid_text);
+	}
+	dstr_copy(&filter->mask_regions_invalid, invalid_text);
+	dstr_free(&invalid_regions);
 
-	filter->center_x = (float)obs_data_get_double(settings, "center_x");
-	filter->center_y = (float)obs_data_get_double(settings, "center_y");
-	filter->inactive_radius = (float)obs_data_get_double(settings, "inactive_radius");
+	filter->passes = (int)obs_data_get_int(settings, "passes");
 
 	filter->angle = (float)obs_data_get_double(settings, "angle");
+	filter->log_step = obs_data_get_bool(settings, "log_step");
+
+	filter->processing_scale_setting =
+		(int)obs_data_get_int(settings, "processing_scale");
+	update_processing_scale(filter, settings);
 	filter->tilt_shift_center =
 		(float)obs_data_get_double(settings, "tilt_shift_center");
 	filter->tilt_shift_width =
@@ -509,6 +733,10 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 	filter->vector_blur_smoothing = (float)obs_data_get_double(settings, "vector_blur_smoothing");
 
 	filter->vector_blur_type = (int)obs_data_get_int(settings, "vector_gradient_type");
+	const int vector_gradient_scale =
+		(int)obs_data_get_int(settings, "vector_gradient_scale");
+	filter->vector_gradient_scale =
+		vector_gradient_scale > 1 ? vector_gradient_scale : 1;
 
 	const char* vector_source_name =
 		obs_data_get_string(settings, "vector_source");
@@ -516,16 +744,14 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 		(vector_source_name && strlen(vector_source_name))
 		? obs_get_source_by_name(vector_source_name)
 		: NULL;
-	if (filter->vector_blur_source)
-		obs_weak_source_release(filter->vector_blur_source);
+	vector_blur_set_source(filter, vector_source);
 	if (vector_source) {
-		filter->vector_blur_source =
-			obs_source_get_weak_source(vector_source);
 		obs_source_release(vector_source);
 	}
-	else {
-		filter->vector_blur_source = NULL;
-	}
+	filter->vector_source_static =
+		obs_data_get_bool(settings, "vector_source_static");
+	// Channel, gradient type, smoothing or scale may have changed.
+	filter->vb_gradient_dirty = true;
 
 
 	const char *source_name = obs_data_get_string(settings, "background");
@@ -552,11 +778,24 @@ static void composite_blur_update(void *data, obs_data_t *settings)
 		filter->background = NULL;
 	}
 
+	filter->idle_release_time =
+		(int)obs_data_get_int(settings, "idle_release_time");
+	// The budget is global, the last instance to change it wins.
+	const int vram_budget_mb =
+		(int)obs_data_get_int(settings, "vram_budget");
+	if (vram_budget_mb != filter->vram_budget_mb) {
+		filter->vram_budget_mb = vram_budget_mb;
+		pthread_mutex_lock(&vram_mutex);
+		vram_global_budget = (uint64_t)vram_budget_mb * 1024 * 1024;
+		pthread_mutex_unlock(&vram_mutex);
+	}
+
 	if (filter->reload) {
 		filter->reload = false;
 		composite_blur_reload_effect(filter);
 		obs_source_update_properties(filter->context);
 	}
+	release_unused_resources(filter);
 
 	if (filter->update) {
 		filter->update(filter);
@@ -582,7 +821,8 @@ static void get_input_source(composite_blur_filter_data_t *filter)
 	const enum gs_color_format format =
 		gs_get_format_from_space(source_space);
 
-	// Set up our input_texrender to catch the output texture.
+	// Set up our input_texrender to catch the output texture, in the
+	// pipeline format picked by composite_blur_video_render.
 	filter->input_texrender =
 		create_or_reset_texrender(filter->input_texrender);
 
@@ -637,6 +877,10 @@ static void draw_output_to_source(composite_blur_filter_data_t *filter)
 	if (filter->param_output_image) {
 		gs_effect_set_texture(filter->param_output_image, texture);
 	}
+	if (filter->param_output_linear) {
+		gs_effect_set_bool(filter->param_output_linear,
+				   filter->pipeline_linear);
+	}
 
 	gs_blend_state_push();
 	gs_blend_function_separate(GS_BLEND_SRCALPHA, GS_BLEND_INVSRCALPHA,
@@ -663,29 +907,696 @@ static void composite_blur_video_render(void *data, gs_effect_t *effect)
 	}
 
 	filter->rendering = true;
+	filter->idle_time = 0.0f;
+	filter->idle_released = false;
+
+	// SDR sources blur in 8 bit targets, dithered by the blur passes.
+	// HDR sources arrive as linear floats, so only they pay for
+	// GS_RGBA16F intermediates.
+	const enum gs_color_space preferred_spaces[] = {
+		GS_CS_SRGB,
+		GS_CS_SRGB_16F,
+		GS_CS_709_EXTENDED,
+	};
+	const enum gs_color_space space = obs_source_get_color_space(
+		obs_filter_get_target(filter->context),
+		OBS_COUNTOF(preferred_spaces), preferred_spaces);
+	filter->pipeline_linear = space != GS_CS_SRGB;
+	const enum gs_color_format prior_format = set_pipeline_format(
+		filter->pipeline_linear ? GS_RGBA16F : GS_RGBA);
 
 	if (filter->video_render) {
 		// 1. Get the input source as a texture renderer
-		//    accessed as filter->input_texrender after call
-		get_input_source(filter);
+		//    accessed as filter->input_texrender after call,
+		//    at the processing resolution.
+		//    Bounded masks limit the passes to their region of
+		//    interest.
+		const int scale = filter->processing_scale;
+		roi_update(filter);
+		processing_scale_begin(filter, scale);
 
 		// 2. Apply effect to texture, and render texture to video
+		//    skipping pixels the mask discards.
+		stencil_update(filter);
 		filter->video_render(filter);
+		filter->stencil_active = false;
+
+		// 3. Upsample the result back to full resolution.
+		processing_scale_end(filter, scale);
 
-		// 3. Apply mask to texture if one is selected by the user.
+		// 4. Apply mask to texture if one is selected by the user.
 		if (filter->mask_type != EFFECT_MASK_TYPE_NONE) {
 			// Swap output and render
 			apply_effect_mask(filter);
 		}
 
-		// 4. Draw result (filter->output_texrender) to source
+		// 5. Draw result (filter->output_texrender) to source
 		draw_output_to_source(filter);
 		filter->rendered = true;
 	}
 
+	set_pipeline_format(prior_format);
 	filter->rendering = false;
 }
 
+/*
+ *  Pixelate, temporal and vector blur depend on per-pixel detail of
+ *  the input, so they always run at full resolution. Returns whether
+ *  the current algorithm can run at a reduced processing scale.
+ */
+static bool processing_scale_supported(composite_blur_filter_data_t *filter)
+{
+	switch (filter->blur_algorithm) {
+	case ALGO_GAUSSIAN:
+		return filter->blur_type != TYPE_VECTOR;
+	case ALGO_BOX:
+	case ALGO_DUAL_KAWASE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ *  Picks the resolution divisor for the blur passes. Auto reduces
+ *  resolution as long as the effective blur extent stays above
+ *  PROCESSING_SCALE_AUTO_MIN_RADIUS processing pixels.
+ */
+static int get_processing_scale(composite_blur_filter_data_t *filter)
+{
+	if (!processing_scale_supported(filter)) {
+		return 1;
+	}
+
+	float radius = 0.0f;
+	switch (filter->blur_algorithm) {
+	case ALGO_GAUSSIAN:
+		radius = filter->radius;
+		break;
+	case ALGO_BOX:
+		// n box passes approach a gaussian with sqrt(n) times the
+		// spread of a single pass.
+		radius = filter->radius * sqrtf((float)filter->passes);
+		break;
+	case ALGO_DUAL_KAWASE:
+		radius = filter->kawase_passes;
+		break;
+	default:
+		return 1;
+	}
+
+	int scale = 1;
+	switch (filter->processing_scale_setting) {
+	case PROCESSING_SCALE_HALF:
+	case PROCESSING_SCALE_QUARTER:
+	case PROCESSING_SCALE_EIGHTH:
+		scale = filter->processing_scale_setting;
+		break;
+	case PROCESSING_SCALE_AUTO:
+		while (scale < PROCESSING_SCALE_EIGHTH &&
+		       radius / (float)(scale * 2) >=
+			       PROCESSING_SCALE_AUTO_MIN_RADIUS) {
+			scale *= 2;
+		}
+		break;
+	default:
+		break;
+	}
+
+	// Over the VRAM budget, trade resolution for memory.
+	for (int i = 0;
+	     i < filter->vram_scale_shift && scale < PROCESSING_SCALE_EIGHTH;
+	     i++) {
+		scale *= 2;
+	}
+	return scale;
+}
+
+/*
+ *  Reads the pixel sized settings and picks the processing scale. The
+ *  settings are kept in processing pixels so the algorithms don't need
+ *  to know about the reduced resolution.
+ */
+static void update_processing_scale(composite_blur_filter_data_t *filter,
+				    obs_data_t *settings)
+{
+	filter->radius = (float)obs_data_get_double(settings, "radius");
+	filter->kawase_passes =
+		(float)obs_data_get_double(settings, "kawase_passes");
+	filter->center_x = (float)obs_data_get_double(settings, "center_x");
+	filter->center_y = (float)obs_data_get_double(settings, "center_y");
+	filter->inactive_radius =
+		(float)obs_data_get_double(settings, "inactive_radius");
+
+	filter->processing_scale = get_processing_scale(filter);
+	if (filter->processing_scale > 1) {
+		const float scale = (float)filter->processing_scale;
+		filter->radius /= scale;
+		filter->kawase_passes /= scale;
+		filter->center_x /= scale;
+		filter->center_y /= scale;
+		filter->inactive_radius /= scale;
+	}
+}
+
+/*
+ *  Returns how far, in full resolution pixels, the current blur can
+ *  spread a pixel, or -1 if the result depends on where a pixel sits
+ *  in the frame (zoom center, tilt-shift band, vector map, pixelate
+ *  grid), in which case the frame can't be cropped.
+ */
+static float get_blur_extent(composite_blur_filter_data_t *filter)
+{
+	const float scale = (float)filter->processing_scale;
+	switch (filter->blur_algorithm) {
+	case ALGO_GAUSSIAN:
+	case ALGO_BOX:
+		if (filter->blur_type == TYPE_ZOOM ||
+		    filter->blur_type == TYPE_TILTSHIFT ||
+		    filter->blur_type == TYPE_VECTOR) {
+			return -1.0f;
+		}
+		// Repeated box passes each extend the footprint by radius.
+		// The gaussian kernel is sampled out to 3 sigma, and
+		// sample_kernel takes radius as sigma. Log-step pre-passes
+		// add a box of up to 2^passes texels on top of that.
+		if (filter->blur_algorithm == ALGO_BOX) {
+			return filter->radius * (float)filter->passes * scale;
+		}
+		if (filter->log_step_passes > 0) {
+			return (3.0f * filter->radius +
+				(float)(1 << filter->log_step_passes)) *
+			       scale;
+		}
+		return 3.0f * filter->radius * scale;
+	case ALGO_DUAL_KAWASE:
+		// Each down/up level pair reaches about 2.5 of its own
+		// texels, and the level sizes double up to kawase_passes.
+		return 5.0f * filter->kawase_passes * scale;
+	case ALGO_TEMPORAL:
+		return 0.0f;
+	default:
+		return -1.0f;
+	}
+}
+
+/*
+ *  Finds the region of interest for this frame. Crop, rectangle and
+ *  circle masks only show the blurred result inside their bounds, so
+ *  the passes can be limited to those bounds padded by the blur extent.
+ *  Inverted masks, background compositing and position dependent blurs
+ *  keep the full frame.
+ */
+static void roi_update(composite_blur_filter_data_t *filter)
+{
+	filter->roi_active = false;
+
+	const float extent = get_blur_extent(filter);
+	if (extent < 0.0f || filter->background) {
+		return;
+	}
+
+	const float w = (float)filter->full_width;
+	const float h = (float)filter->full_height;
+	float left, top, right, bottom;
+	switch (filter->mask_type) {
+	case EFFECT_MASK_TYPE_CROP:
+		if (filter->mask_crop_invert) {
+			return;
+		}
+		left = filter->mask_crop_left / 100.0f * w;
+		right = (1.0f - filter->mask_crop_right / 100.0f) * w;
+		top = filter->mask_crop_top / 100.0f * h;
+		bottom = (1.0f - filter->mask_crop_bot / 100.0f) * h;
+		break;
+	case EFFECT_MASK_TYPE_RECT:
+		if (filter->mask_rect_inv) {
+			return;
+		}
+		left = (filter->mask_rect_center_x -
+			filter->mask_rect_width / 2.0f) /
+		       100.0f * w;
+		right = (filter->mask_rect_center_x +
+			 filter->mask_rect_width / 2.0f) /
+			100.0f * w;
+		top = (filter->mask_rect_center_y -
+		       filter->mask_rect_height / 2.0f) /
+		      100.0f * h;
+		bottom = (filter->mask_rect_center_y +
+			  filter->mask_rect_height / 2.0f) /
+			 100.0f * h;
+		break;
+	case EFFECT_MASK_TYPE_REGIONS: {
+		// The union of all regions, so any number of regions still
+		// costs a single blur.
+		if (filter->mask_regions_inv || !filter->mask_region_count) {
+			return;
+		}
+		const float min_wh = fminf(w, h);
+		left = w;
+		top = h;
+		right = 0.0f;
+		bottom = 0.0f;
+		for (int i = 0; i < filter->mask_region_count; i++) {
+			const effect_mask_region_t *region =
+				&filter->mask_regions[i];
+			const bool circle =
+				region->type == EFFECT_MASK_REGION_CIRCLE;
+			const float cx = region->center_x / 100.0f * w;
+			const float cy = region->center_y / 100.0f * h;
+			const float hw = circle ? region->width / 100.0f * min_wh
+						: region->width / 200.0f * w;
+			const float hh = circle
+						 ? region->width / 100.0f * min_wh
+						 : region->height / 200.0f * h;
+			left = fminf(left, cx - hw);
+			right = fmaxf(right, cx + hw);
+			top = fminf(top, cy - hh);
+			bottom = fmaxf(bottom, cy + hh);
+		}
+		break;
+	}
+	case EFFECT_MASK_TYPE_CIRCLE: {
+		if (filter->mask_circle_inv) {
+			return;
+		}
+		const float r = filter->mask_circle_radius / 100.0f *
+				fminf(w, h);
+		const float cx = filter->mask_circle_center_x / 100.0f * w;
+		const float cy = filter->mask_circle_center_y / 100.0f * h;
+		left = cx - r;
+		right = cx + r;
+		top = cy - r;
+		bottom = cy + r;
+		break;
+	}
+	default:
+		return;
+	}
+
+	left = floorf(fmaxf(left - extent, 0.0f));
+	top = floorf(fmaxf(top - extent, 0.0f));
+	right = ceilf(fminf(right + extent, w));
+	bottom = ceilf(fminf(bottom + extent, h));
+	if (right <= left || bottom <= top ||
+	    (right - left) * (bottom - top) > ROI_MAX_COVERAGE * w * h) {
+		return;
+	}
+
+	filter->roi_x = (uint32_t)left;
+	filter->roi_y = (uint32_t)top;
+	filter->roi_width = (uint32_t)(right - left);
+	filter->roi_height = (uint32_t)(bottom - top);
+	filter->roi_active = true;
+}
+
+static void fill_texrender(gs_texrender_t *render, float value)
+{
+	struct vec4 color;
+	vec4_set(&color, value, value, value, value);
+	if (gs_texrender_begin(render, 1, 1)) {
+		gs_clear(GS_CLEAR_COLOR, &color, 0.0f, 0);
+		gs_texrender_end(render);
+	}
+}
+
+/*
+ *  Builds the early rejection stencil for the gaussian and box passes.
+ *  The mask is rendered with a transparent input and an opaque blur,
+ *  which leaves its coverage in the output, then dilated by the blur
+ *  extent with a box pyramid and written to stencil_zs as 0 (the
+ *  libobs stencil reference value) where covered, 1 elsewhere. Passes
+ *  test for 0, so only pixels that can reach the masked output are
+ *  shaded. A region of interest already limits the passes to the mask
+ *  bounds, so the stencil is only used without one.
+ *
+ *  Coverage comes from apply_effect_mask, so building the stencil draws
+ *  the whole mask pipeline a second time. It is only rebuilt when the
+ *  mask can have changed: after a settings update, a size or blur
+ *  reach change, a re-baked source or image mask channel, and every
+ *  frame for source masks that are not static.
+ */
+static void stencil_update(composite_blur_filter_data_t *filter)
+{
+	filter->stencil_active = false;
+
+	if (filter->mask_type == EFFECT_MASK_TYPE_NONE || filter->roi_active ||
+	    !filter->stencil_effect || !filter->effect_mask_effect ||
+	    (filter->blur_algorithm != ALGO_GAUSSIAN &&
+	     filter->blur_algorithm != ALGO_BOX)) {
+		return;
+	}
+	const float extent = get_blur_extent(filter);
+	if (extent < 0.0f) {
+		return;
+	}
+
+	const uint32_t width = filter->width;
+	const uint32_t height = filter->height;
+	// Dilation in processing pixels, see step 2.
+	const float reach = extent / (float)filter->processing_scale + 2.0f;
+
+	// Source and image masks are baked first (the mask pass reuses the
+	// bake), so a changed channel shows in mask_channel_version.
+	const bool channel_mask =
+		filter->mask_type == EFFECT_MASK_TYPE_SOURCE ||
+		filter->mask_type == EFFECT_MASK_TYPE_IMAGE;
+	if (channel_mask && !mask_source_channel(filter)) {
+		return;
+	}
+	const bool live_mask = filter->mask_type == EFFECT_MASK_TYPE_SOURCE &&
+			       !filter->mask_source_static;
+	if (filter->stencil_valid && !live_mask &&
+	    filter->stencil_width == width &&
+	    filter->stencil_height == height &&
+	    filter->stencil_reach == reach &&
+	    filter->stencil_mask_version == filter->mask_channel_version) {
+		filter->stencil_active = true;
+		return;
+	}
+	filter->stencil_valid = false;
+
+	// 1. Mask coverage at the processing resolution.
+	filter->stencil_zero = create_or_reset_texrender(filter->stencil_zero);
+	filter->stencil_one = create_or_reset_texrender(filter->stencil_one);
+	if (!filter->stencil_coverage) {
+		filter->stencil_coverage =
+			gs_texrender_create(GS_R32F, GS_ZS_NONE);
+	} else {
+		gs_texrender_reset(filter->stencil_coverage);
+	}
+	fill_texrender(filter->stencil_zero, 0.0f);
+	fill_texrender(filter->stencil_one, 1.0f);
+
+	gs_texrender_t *input = filter->input_texrender;
+	gs_texrender_t *output = filter->output_texrender;
+	gs_texrender_t *render = filter->render;
+	filter->input_texrender = filter->stencil_zero;
+	filter->output_texrender = filter->stencil_one;
+	filter->render = filter->stencil_coverage;
+	apply_effect_mask(filter);
+	// The mask swaps output into render before drawing.
+	filter->stencil_coverage = filter->output_texrender;
+	filter->stencil_one = filter->render;
+	filter->input_texrender = input;
+	filter->output_texrender = output;
+	filter->render = render;
+	gs_texture_t *mask_coverage =
+		gs_texrender_get_texture(filter->stencil_coverage);
+	if (!mask_coverage || gs_texture_get_width(mask_coverage) != width ||
+	    gs_texture_get_height(mask_coverage) != height) {
+		// The mask could not render (e.g. missing mask source).
+		return;
+	}
+
+	// 2. Dilate by the blur extent, in processing pixels, plus the
+	//    support of the upsample that follows reduced scale passes.
+	//    The later separable passes read earlier passes' output up to
+	//    the full kernel reach away, so anything less leaves them
+	//    reading pixels the stencil skipped.
+	int level = (int)ceilf(log2f(reach));
+	level = level < 1 ? 1 : level > PYRAMID_MAX_LEVELS ? PYRAMID_MAX_LEVELS
+							  : level;
+
+	set_blending_parameters();
+
+	blur_pyramid_t *pyramid = pyramid_acquire(filter->pyramids,
+						  &filter->stencil_box,
+						  mask_coverage, "DrawBox");
+	gs_texture_t *coverage = pyramid_get_level(pyramid, level);
+
+	// 3. Write the stencil.
+	if (!filter->stencil_zs || filter->stencil_width != width ||
+	    filter->stencil_height != height) {
+		if (filter->stencil_zs) {
+			gs_zstencil_destroy(filter->stencil_zs);
+		}
+		filter->stencil_zs = gs_zstencil_create(width, height, GS_Z24_S8);
+		filter->stencil_width = width;
+		filter->stencil_height = height;
+	}
+	if (!filter->stencil_target) {
+		filter->stencil_target = gs_texrender_create(GS_R8, GS_ZS_NONE);
+	} else {
+		gs_texrender_reset(filter->stencil_target);
+	}
+	if (!filter->stencil_zs || !coverage) {
+		gs_blend_state_pop();
+		return;
+	}
+
+	// The write pass shares its parameters with the pyramid's box
+	// reduction, so they are set through the same bindings.
+	gs_effect_t *effect = filter->stencil_effect;
+	effect_param_set_texture(&filter->stencil_box.image, coverage);
+	struct vec2 texel_step_size;
+	texel_step_size.x = 1.0f / (float)gs_texture_get_width(coverage);
+	texel_step_size.y = 1.0f / (float)gs_texture_get_height(coverage);
+	effect_param_set_vec2(&filter->stencil_box.texel_step,
+			      &texel_step_size);
+
+	if (gs_texrender_begin(filter->stencil_target, width, height)) {
+		gs_set_render_target(gs_get_render_target(),
+				     filter->stencil_zs);
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f,
+			 100.0f);
+		gs_clear(GS_CLEAR_STENCIL, NULL, 0.0f, 1);
+		gs_enable_color(false, false, false, false);
+		gs_enable_stencil_test(true);
+		gs_enable_stencil_write(true);
+		gs_stencil_function(GS_STENCIL_BOTH, GS_ALWAYS);
+		gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_REPLACE);
+		while (gs_effect_loop(effect, "Write"))
+			gs_draw_sprite(coverage, 0, width, height);
+		gs_enable_stencil_write(false);
+		gs_enable_stencil_test(false);
+		gs_enable_color(true, true, true, true);
+		gs_texrender_end(filter->stencil_target);
+		filter->stencil_active = true;
+		filter->stencil_valid = true;
+		filter->stencil_reach = reach;
+		filter->stencil_mask_version = filter->mask_channel_version;
+	}
+
+	gs_blend_state_pop();
+}
+
+/*
+ *  Binds the early rejection stencil to the render target begun last.
+ *  Call between gs_texrender_begin and gs_texrender_end of a blur
+ *  pass. Pixels outside the stencil keep stale contents, which the
+ *  mask pass never shows. Targets of any other size are left alone.
+ */
+void stencil_pass_begin(composite_blur_filter_data_t *data)
+{
+	if (!data->stencil_active) {
+		return;
+	}
+	gs_texture_t *target = gs_get_render_target();
+	if (!target || gs_texture_get_width(target) != data->stencil_width ||
+	    gs_texture_get_height(target) != data->stencil_height) {
+		return;
+	}
+	gs_set_render_target(target, data->stencil_zs);
+	gs_enable_stencil_test(true);
+	gs_enable_stencil_write(false);
+	gs_stencil_function(GS_STENCIL_BOTH, GS_EQUAL);
+	gs_stencil_op(GS_STENCIL_BOTH, GS_KEEP, GS_KEEP, GS_KEEP);
+}
+
+void stencil_pass_end(composite_blur_filter_data_t *data)
+{
+	if (data->stencil_active) {
+		gs_enable_stencil_test(false);
+	}
+}
+
+/*
+ *  Captures the input and switches width/height to the processing
+ *  resolution. The input is captured at full resolution and reduced in
+ *  2x box steps, since a single bilinear or 4 tap reduction skips
+ *  pixels at 1/4 and 1/8 and shimmers on moving content. The full
+ *  capture is kept, as masks composite against it. With a region of
+ *  interest the first step also crops to it.
+ */
+static void processing_scale_begin(composite_blur_filter_data_t *filter,
+				   int scale)
+{
+	const bool roi = filter->roi_active;
+	get_input_source(filter);
+	if (scale <= 1 && !roi) {
+		return;
+	}
+
+	uint32_t source_x = roi ? filter->roi_x : 0;
+	uint32_t source_y = roi ? filter->roi_y : 0;
+	uint32_t source_cx = roi ? filter->roi_width : filter->full_width;
+	uint32_t source_cy = roi ? filter->roi_height : filter->full_height;
+	const uint32_t full_cx = source_cx;
+	const uint32_t full_cy = source_cy;
+
+	// Ping-pong between processing_input_texrender and render, which
+	// the blur passes reset before use.
+	gs_texrender_t *targets[2] = {filter->processing_input_texrender,
+				      filter->render};
+	gs_texture_t *texture =
+		gs_texrender_get_texture(filter->input_texrender);
+	int current = 0;
+	for (int step = scale > 1 ? 2 : 1;; step *= 2) {
+		const uint32_t width = (full_cx + step - 1) / step;
+		const uint32_t height = (full_cy + step - 1) / step;
+		targets[current] = create_or_reset_texrender(targets[current]);
+		if (gs_texrender_begin(targets[current], width, height)) {
+			gs_ortho(0.0f, (float)width, 0.0f, (float)height,
+				 -100.0f, 100.0f);
+			resample_draw(filter, texture, source_x, source_y,
+				      source_cx, source_cy, width, height,
+				      step > 1 ? "Downsample" : "Draw");
+			gs_texrender_end(targets[current]);
+		}
+		texture = gs_texrender_get_texture(targets[current]);
+		source_x = 0;
+		source_y = 0;
+		source_cx = width;
+		source_cy = height;
+		if (step >= scale) {
+			break;
+		}
+		current ^= 1;
+	}
+
+	// The reduced copy becomes the input of the blur passes.
+	filter->processing_input_texrender = filter->input_texrender;
+	filter->input_texrender = targets[current];
+	filter->render = targets[current ^ 1];
+
+	filter->width = source_cx;
+	filter->height = source_cy;
+}
+
+/*
+ *  Restores full resolution and upsamples output_texrender with a
+ *  bicubic B-spline so the result is ready for masking and output.
+ *  A region of interest result is drawn back into its rectangle over
+ *  a copy of the unblurred input.
+ */
+static void processing_scale_end(composite_blur_filter_data_t *filter,
+				 int scale)
+{
+	const bool roi = filter->roi_active;
+	if (scale <= 1 && !roi) {
+		return;
+	}
+
+	filter->width = filter->full_width;
+	filter->height = filter->full_height;
+
+	if (filter->mask_type != EFFECT_MASK_TYPE_NONE) {
+		gs_texrender_t *tmp = filter->input_texrender;
+		filter->input_texrender = filter->processing_input_texrender;
+		filter->processing_input_texrender = tmp;
+	}
+
+	filter->render = create_or_reset_texrender(filter->render);
+	const char *technique = scale > 1 ? "Upsample" : "Draw";
+	if (!roi) {
+		resample_texture(
+			filter,
+			gs_texrender_get_texture(filter->output_texrender),
+			filter->render, filter->width, filter->height,
+			technique);
+	} else if (gs_texrender_begin(filter->render, filter->width,
+				      filter->height)) {
+		gs_texture_t *output =
+			gs_texrender_get_texture(filter->output_texrender);
+		gs_ortho(0.0f, (float)filter->width, 0.0f,
+			 (float)filter->height, -100.0f, 100.0f);
+		resample_draw(filter,
+			      gs_texrender_get_texture(filter->input_texrender),
+			      0, 0, filter->width, filter->height,
+			      filter->width, filter->height, "Draw");
+		gs_matrix_push();
+		gs_matrix_translate3f((float)filter->roi_x,
+				      (float)filter->roi_y, 0.0f);
+		resample_draw(filter, output, 0, 0,
+			      gs_texture_get_width(output),
+			      gs_texture_get_height(output), filter->roi_width,
+			      filter->roi_height, technique);
+		gs_matrix_pop();
+		gs_texrender_end(filter->render);
+	}
+
+	gs_texrender_t *tmp = filter->output_texrender;
+	filter->output_texrender = filter->render;
+	filter->render = tmp;
+}
+
+static void resample_texture(composite_blur_filter_data_t *filter,
+			     gs_texture_t *texture, gs_texrender_t *dest,
+			     uint32_t width, uint32_t height,
+			     const char *technique)
+{
+	if (gs_texrender_begin(dest, width, height)) {
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f,
+			 100.0f);
+		resample_draw(filter, texture, 0, 0,
+			      gs_texture_get_width(texture),
+			      gs_texture_get_height(texture), width, height,
+			      technique);
+		gs_texrender_end(dest);
+	}
+}
+
+/*
+ *  Draws the source_cx x source_cy sub-rectangle of texture at
+ *  (source_x, source_y) as a width x height sprite at the current
+ *  transform, inside an active texrender.
+ */
+static void resample_draw(composite_blur_filter_data_t *filter,
+			  gs_texture_t *texture, uint32_t source_x,
+			  uint32_t source_y, uint32_t source_cx,
+			  uint32_t source_cy, uint32_t width, uint32_t height,
+			  const char *technique)
+{
+	gs_effect_t *effect = filter->resample_effect;
+
+	if (!effect || !texture || !source_cx || !source_cy) {
+		return;
+	}
+
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	gs_effect_set_texture(image, texture);
+
+	const uint32_t source_width = gs_texture_get_width(texture);
+	const uint32_t source_height = gs_texture_get_height(texture);
+	struct vec2 source_size;
+	source_size.x = (float)source_width;
+	source_size.y = (float)source_height;
+	if (filter->param_resample_source_size) {
+		gs_effect_set_vec2(filter->param_resample_source_size,
+				   &source_size);
+	}
+
+	const float scale = source_cx > width
+				    ? (float)source_cx / (float)width
+				    : (float)width / (float)source_cx;
+	if (filter->param_resample_scale) {
+		gs_effect_set_float(filter->param_resample_scale, scale);
+	}
+
+	set_blending_parameters();
+
+	gs_matrix_push();
+	gs_matrix_scale3f((float)width / (float)source_cx,
+			  (float)height / (float)source_cy, 1.0f);
+	while (gs_effect_loop(effect, technique))
+		gs_draw_sprite_subregion(texture, 0, source_x, source_y,
+					 source_cx, source_cy);
+	gs_matrix_pop();
+
+	gs_blend_state_pop();
+}
+
 static void apply_effect_mask(composite_blur_filter_data_t *filter)
 {
 	switch (filter->mask_type) {
@@ -704,22 +1615,71 @@ static void apply_effect_mask(composite_blur_filter_data_t *filter)
 	case EFFECT_MASK_TYPE_IMAGE:
 		apply_effect_mask_source(filter);
 		break;
+	case EFFECT_MASK_TYPE_REGIONS:
+		apply_effect_mask_regions(filter);
+		break;
 	}
 }
 
-static void apply_effect_mask_source(composite_blur_filter_data_t *filter)
+/*
+ *  Returns the decoded image mask texture, or NULL while it is still
+ *  loading. The shared cache entry is keyed on the filter size so the
+ *  worker can downscale oversized images before upload.
+ */
+static gs_texture_t *
+mask_image_texture(composite_blur_filter_data_t *filter)
 {
-	// Get source
+	const char *path = filter->mask_image_path.array;
+	if (!path || !*path) {
+		return NULL;
+	}
+	const uint32_t width = filter->full_width;
+	const uint32_t height = filter->full_height;
+	if (!filter->mask_image || filter->mask_image->max_width != width ||
+	    filter->mask_image->max_height != height) {
+		image_mask_release(filter->mask_image);
+		filter->mask_image = image_mask_acquire(path, width, height);
+	}
+	return image_mask_get_texture(filter->mask_image);
+}
+
+/*
+ *  Returns the source or image mask baked into a single channel
+ *  texture, with the channel weights, invert and multiplier already
+ *  applied. Source masks are re-rendered every frame unless marked
+ *  static, image masks only when the settings change.
+ */
+static gs_texture_t *
+mask_source_channel(composite_blur_filter_data_t *filter)
+{
+	const bool is_source = filter->mask_type == EFFECT_MASK_TYPE_SOURCE;
+	const uint64_t frame_time = obs_get_video_frame_time();
+	if (!is_source) {
+		gs_texture_t *image_texture = mask_image_texture(filter);
+		if (image_texture != filter->mask_image_texture) {
+			filter->mask_image_texture = image_texture;
+			filter->mask_channel_dirty = true;
+		}
+		// Pass through until the background decode finishes.
+		if (!image_texture) {
+			return NULL;
+		}
+	}
+	if (filter->mask_channel_render && !filter->mask_channel_dirty &&
+	    (!is_source || filter->mask_source_static ||
+	     filter->mask_channel_frame_time == frame_time)) {
+		return gs_texrender_get_texture(filter->mask_channel_render);
+	}
+
 	gs_texture_t *alpha_texture = NULL;
-	gs_texrender_t *source_render = NULL;
-	if (filter->mask_type == EFFECT_MASK_TYPE_SOURCE) {
+	if (is_source) {
 		obs_source_t *source =
 			filter->mask_source_source
 				? obs_weak_source_get_source(
 					  filter->mask_source_source)
 				: NULL;
 		if (!source) {
-			return;
+			return NULL;
 		}
 
 		const enum gs_color_space preferred_spaces[] = {
@@ -733,14 +1693,16 @@ static void apply_effect_mask_source(composite_blur_filter_data_t *filter)
 		const enum gs_color_format format =
 			gs_get_format_from_space(space);
 
-		// Set up a tex renderer for source
-		source_render = gs_texrender_create(format, GS_ZS_NONE);
+		// Persistent tex renderer for the source
+		filter->mask_source_render = create_or_reset_texrender_format(
+			filter->mask_source_render, format);
 		uint32_t base_width = obs_source_get_width(source);
 		uint32_t base_height = obs_source_get_height(source);
 		gs_blend_state_push();
 		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
 		if (gs_texrender_begin_with_color_space(
-			    source_render, base_width, base_height, space)) {
+			    filter->mask_source_render, base_width,
+			    base_height, space)) {
 			const float w = (float)base_width;
 			const float h = (float)base_height;
 			struct vec4 clear_color;
@@ -748,38 +1710,28 @@ static void apply_effect_mask_source(composite_blur_filter_data_t *filter)
 			gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
 			gs_ortho(0.0f, w, 0.0f, h, -100.0f, 100.0f);
 			obs_source_video_render(source);
-			gs_texrender_end(source_render);
+			gs_texrender_end(filter->mask_source_render);
 		}
 		gs_blend_state_pop();
 		obs_source_release(source);
-		alpha_texture = gs_texrender_get_texture(source_render);
-	} else if (filter->mask_type == EFFECT_MASK_TYPE_IMAGE &&
-		   filter->mask_image) {
-		alpha_texture = filter->mask_image->texture;
+		alpha_texture =
+			gs_texrender_get_texture(filter->mask_source_render);
+	} else {
+		alpha_texture = filter->mask_image_texture;
 	}
 
-	// Swap output with render
-	gs_texrender_t *tmp = filter->output_texrender;
-	filter->output_texrender = filter->render;
-	filter->render = tmp;
-
 	gs_effect_t *effect = filter->effect_mask_effect;
-	gs_texture_t *texture =
-		gs_texrender_get_texture(filter->input_texrender);
-	gs_texture_t *filtered_texture =
-		gs_texrender_get_texture(filter->render);
-
-	if (!effect || !texture || !filtered_texture) {
-		gs_texrender_destroy(source_render);
-		return;
+	if (!effect || !alpha_texture) {
+		return NULL;
 	}
-	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
-	gs_effect_set_texture(image, texture);
 
-	if (filter->param_filtered_image) {
-		gs_effect_set_texture(filter->param_filtered_image,
-				      filtered_texture);
-	}
+	const uint32_t scale = filter->mask_source_scale > 0
+				       ? (uint32_t)filter->mask_source_scale
+				       : 1;
+	uint32_t width = gs_texture_get_width(alpha_texture) / scale;
+	uint32_t height = gs_texture_get_height(alpha_texture) / scale;
+	width = width > 0 ? width : 1;
+	height = height > 0 ? height : 1;
 
 	if (filter->param_mask_source_alpha_source) {
 		gs_effect_set_texture(filter->param_mask_source_alpha_source,
@@ -791,8 +1743,6 @@ static void apply_effect_mask_source(composite_blur_filter_data_t *filter)
 				   filter->mask_source_invert);
 	}
 
-	// TODO- Move weights calculation to update.
-	//       Move vec4 weights into data structure.
 	struct vec4 weights;
 	weights.x = filter->mask_source_filter_red;
 	weights.y = filter->mask_source_filter_green;
@@ -807,6 +1757,71 @@ static void apply_effect_mask_source(composite_blur_filter_data_t *filter)
 		gs_effect_set_float(filter->param_mask_source_multiplier,
 				    filter->mask_source_multiplier);
 	}
+
+	filter->mask_channel_render = create_or_reset_texrender_format(
+		filter->mask_channel_render, GS_R8);
+
+	set_blending_parameters();
+
+	if (gs_texrender_begin(filter->mask_channel_render, width, height)) {
+		gs_ortho(0.0f, (float)width, 0.0f, (float)height, -100.0f,
+			 100.0f);
+		while (gs_effect_loop(effect, "Channel"))
+			gs_draw_sprite(alpha_texture, 0, width, height);
+		gs_texrender_end(filter->mask_channel_render);
+	}
+
+	gs_blend_state_pop();
+
+	filter->mask_channel_dirty = false;
+	filter->mask_channel_frame_time = frame_time;
+	filter->mask_channel_version++;
+	return gs_texrender_get_texture(filter->mask_channel_render);
+}
+
+static void apply_effect_mask_source(composite_blur_filter_data_t *filter)
+{
+	gs_texture_t *mask_texture = mask_source_channel(filter);
+	if (!mask_texture) {
+		// Image masks show the unfiltered input until decoded.
+		if (filter->mask_type == EFFECT_MASK_TYPE_IMAGE) {
+			gs_texture_t *texture = gs_texrender_get_texture(
+				filter->input_texrender);
+			filter->output_texrender =
+				create_or_reset_texrender(
+					filter->output_texrender);
+			texrender_set_texture(texture,
+					      filter->output_texrender);
+		}
+		return;
+	}
+
+	// Swap output with render
+	gs_texrender_t *tmp = filter->output_texrender;
+	filter->output_texrender = filter->render;
+	filter->render = tmp;
+
+	gs_effect_t *effect = filter->effect_mask_effect;
+	gs_texture_t *texture =
+		gs_texrender_get_texture(filter->input_texrender);
+	gs_texture_t *filtered_texture =
+		gs_texrender_get_texture(filter->render);
+
+	if (!effect || !texture || !filtered_texture) {
+		return;
+	}
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	gs_effect_set_texture(image, texture);
+
+	if (filter->param_filtered_image) {
+		gs_effect_set_texture(filter->param_filtered_image,
+				      filtered_texture);
+	}
+
+	if (filter->param_mask_source_alpha_source) {
+		gs_effect_set_texture(filter->param_mask_source_alpha_source,
+				      mask_texture);
+	}
 	set_blending_parameters();
 
 	filter->output_texrender =
@@ -816,13 +1831,11 @@ static void apply_effect_mask_source(composite_blur_filter_data_t *filter)
 			       filter->height)) {
 		gs_ortho(0.0f, (float)filter->width, 0.0f,
 			 (float)filter->height, -100.0f, 100.0f);
-		while (gs_effect_loop(effect, "Draw"))
+		while (gs_effect_loop(effect, "DrawBaked"))
 			gs_draw_sprite(texture, 0, filter->width,
 				       filter->height);
 		gs_texrender_end(filter->output_texrender);
 	}
-	texture = gs_texrender_get_texture(filter->output_texrender);
-	gs_texrender_destroy(source_render);
 	gs_blend_state_pop();
 }
 
@@ -987,9 +2000,81 @@ static void apply_effect_mask_crop(composite_blur_filter_data_t *filter)
 				    radius);
 	}
 
-	float feathering = filter->mask_crop_feathering / 100.0f;
-	if (filter->param_mask_crop_feathering) {
-		gs_effect_set_float(filter->param_mask_crop_feathering,
+	float feathering = filter->mask_crop_feathering / 100.0f;
+	if (filter->param_mask_crop_feathering) {
+		gs_effect_set_float(filter->param_mask_crop_feathering,
+				    feathering);
+	}
+	set_blending_parameters();
+
+	filter->output_texrender =
+		create_or_reset_texrender(filter->output_texrender);
+
+	if (gs_texrender_begin(filter->output_texrender, filter->width,
+			       filter->height)) {
+		gs_ortho(0.0f, (float)filter->width, 0.0f,
+			 (float)filter->height, -100.0f, 100.0f);
+		while (gs_effect_loop(effect, "Draw"))
+			gs_draw_sprite(texture, 0, filter->width,
+				       filter->height);
+		gs_texrender_end(filter->output_texrender);
+	}
+	texture = gs_texrender_get_texture(filter->output_texrender);
+	gs_blend_state_pop();
+}
+
+static void apply_effect_mask_circle(composite_blur_filter_data_t *filter)
+{
+	// Swap output with render
+	gs_texrender_t *tmp = filter->output_texrender;
+	filter->output_texrender = filter->render;
+	filter->render = tmp;
+
+	gs_effect_t *effect = filter->effect_mask_effect;
+	gs_texture_t *texture =
+		gs_texrender_get_texture(filter->input_texrender);
+	gs_texture_t *filtered_texture =
+		gs_texrender_get_texture(filter->render);
+
+	if (!effect || !texture || !filtered_texture) {
+		return;
+	}
+	gs_eparam_t *image = gs_effect_get_param_by_name(effect, "image");
+	gs_effect_set_texture(image, texture);
+
+	if (filter->param_filtered_image) {
+		gs_effect_set_texture(filter->param_filtered_image,
+				      filtered_texture);
+	}
+
+	struct vec2 center;
+	center.x = filter->mask_circle_center_x / 100.0f;
+	center.y = filter->mask_circle_center_y / 100.0f;
+	if (filter->param_mask_circle_center) {
+		gs_effect_set_vec2(filter->param_mask_circle_center, &center);
+	}
+
+	struct vec2 uv_scale;
+	uv_scale.x = filter->width / (float)fmin(filter->width, filter->height);
+	uv_scale.y =
+		filter->height / (float)fmin(filter->width, filter->height);
+	if (filter->param_mask_circle_uv_scale) {
+		gs_effect_set_vec2(filter->param_mask_circle_uv_scale,
+				   &uv_scale);
+	}
+
+	bool invert = filter->mask_circle_inv;
+	if (filter->param_mask_circle_inv) {
+		gs_effect_set_bool(filter->param_mask_circle_inv, invert);
+	}
+
+	float radius = filter->mask_circle_radius / 100.0f;
+	if (filter->param_mask_circle_radius) {
+		gs_effect_set_float(filter->param_mask_circle_radius, radius);
+	}
+	float feathering = filter->mask_circle_feathering / 100.0f;
+	if (filter->param_mask_circle_feathering) {
+		gs_effect_set_float(filter->param_mask_circle_feathering,
 				    feathering);
 	}
 	set_blending_parameters();
@@ -1010,7 +2095,11 @@ static void apply_effect_mask_crop(composite_blur_filter_data_t *filter)
 	gs_blend_state_pop();
 }
 
-static void apply_effect_mask_circle(composite_blur_filter_data_t *filter)
+/*
+ *  Masks any number of rectangles and circles, up to
+ *  EFFECT_MASK_MAX_REGIONS, in a single pass over one blur result.
+ */
+static void apply_effect_mask_regions(composite_blur_filter_data_t *filter)
 {
 	// Swap output with render
 	gs_texrender_t *tmp = filter->output_texrender;
@@ -1034,35 +2123,45 @@ static void apply_effect_mask_circle(composite_blur_filter_data_t *filter)
 				      filtered_texture);
 	}
 
-	struct vec2 center;
-	center.x = filter->mask_circle_center_x / 100.0f;
-	center.y = filter->mask_circle_center_y / 100.0f;
-	if (filter->param_mask_circle_center) {
-		gs_effect_set_vec2(filter->param_mask_circle_center, &center);
-	}
-
 	struct vec2 uv_scale;
 	uv_scale.x = filter->width / (float)fmin(filter->width, filter->height);
 	uv_scale.y =
 		filter->height / (float)fmin(filter->width, filter->height);
-	if (filter->param_mask_circle_uv_scale) {
-		gs_effect_set_vec2(filter->param_mask_circle_uv_scale,
+	if (filter->param_mask_regions_uv_scale) {
+		gs_effect_set_vec2(filter->param_mask_regions_uv_scale,
 				   &uv_scale);
 	}
 
-	bool invert = filter->mask_circle_inv;
-	if (filter->param_mask_circle_inv) {
-		gs_effect_set_bool(filter->param_mask_circle_inv, invert);
+	struct vec4 shapes[EFFECT_MASK_MAX_REGIONS];
+	struct vec4 params[EFFECT_MASK_MAX_REGIONS];
+	for (int i = 0; i < filter->mask_region_count; i++) {
+		const effect_mask_region_t *region = &filter->mask_regions[i];
+		const bool circle = region->type == EFFECT_MASK_REGION_CIRCLE;
+		shapes[i].x = region->center_x / 100.0f * uv_scale.x;
+		shapes[i].y = region->center_y / 100.0f * uv_scale.y;
+		shapes[i].z = circle ? region->width / 100.0f
+				     : region->width / 200.0f * uv_scale.x;
+		shapes[i].w = circle ? region->width / 100.0f
+				     : region->height / 200.0f * uv_scale.y;
+		vec4_set(&params[i], circle ? 1.0f : 0.0f,
+			 region->feathering / 100.0f, 0.0f, 0.0f);
 	}
-
-	float radius = filter->mask_circle_radius / 100.0f;
-	if (filter->param_mask_circle_radius) {
-		gs_effect_set_float(filter->param_mask_circle_radius, radius);
+	const size_t count = (size_t)filter->mask_region_count;
+	if (filter->param_mask_regions_shape && count) {
+		gs_effect_set_val(filter->param_mask_regions_shape, shapes,
+				  count * sizeof(struct vec4));
 	}
-	float feathering = filter->mask_circle_feathering / 100.0f;
-	if (filter->param_mask_circle_feathering) {
-		gs_effect_set_float(filter->param_mask_circle_feathering,
-				    feathering);
+	if (filter->param_mask_regions_params && count) {
+		gs_effect_set_val(filter->param_mask_regions_params, params,
+				  count * sizeof(struct vec4));
+	}
+	if (filter->param_mask_regions_count) {
+		gs_effect_set_int(filter->param_mask_regions_count,
+				  filter->mask_region_count);
+	}
+	if (filter->param_mask_regions_inv) {
+		gs_effect_set_bool(filter->param_mask_regions_inv,
+				   filter->mask_regions_inv);
 	}
 	set_blending_parameters();
 
@@ -1078,10 +2177,99 @@ static void apply_effect_mask_circle(composite_blur_filter_data_t *filter)
 				       filter->height);
 		gs_texrender_end(filter->output_texrender);
 	}
-	texture = gs_texrender_get_texture(filter->output_texrender);
 	gs_blend_state_pop();
 }
 
+/*
+ *  Parses one regions mask entry, either
+ *  "rect <center x> <center y> <width> <height> [feathering]" or
+ *  "circle <center x> <center y> <radius> [feathering]", all in percent.
+ */
+static bool parse_mask_region(const char *text, effect_mask_region_t *region)
+{
+	char shape[16] = {0};
+	float v[5] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+	if (!text) {
+		return false;
+	}
+	const int n = sscanf(text, "%15s %f %f %f %f %f", shape, &v[0], &v[1],
+			     &v[2], &v[3], &v[4]);
+	if (n >= 4 && astrcmpi(shape, "circle") == 0) {
+		region->type = EFFECT_MASK_REGION_CIRCLE;
+		region->width = v[2];
+		region->height = v[2];
+		region->feathering = n >= 5 ? v[3] : 0.0f;
+	} else if (n >= 5 && (astrcmpi(shape, "rect") == 0 ||
+			      astrcmpi(shape, "rectangle") == 0)) {
+		region->type = EFFECT_MASK_REGION_RECT;
+		region->width = v[2];
+		region->height = v[3];
+		region->feathering = n >= 6 ? v[4] : 0.0f;
+	} else {
+		return false;
+	}
+	region->center_x = v[0];
+	region->center_y = v[1];
+	return region->width > 0.0f && region->height > 0.0f;
+}
+
+/*
+ *  Parses the regions list of settings into regions, returning how
+ *  many are valid. Entries that don't parse, and entries past
+ *  EFFECT_MASK_MAX_REGIONS, are appended to invalid one per line.
+ */
+static int parse_mask_regions(obs_data_t *settings,
+			      effect_mask_region_t *regions,
+			      struct dstr *invalid)
+{
+	int count = 0;
+	obs_data_array_t *list =
+		obs_data_get_array(settings, "effect_mask_regions_list");
+	const size_t items = list ? obs_data_array_count(list) : 0;
+	for (size_t i = 0; i < items; i++) {
+		obs_data_t *item = obs_data_array_item(list, i);
+		const char *text = obs_data_get_string(item, "value");
+		if (count < EFFECT_MASK_MAX_REGIONS &&
+		    parse_mask_region(text, &regions[count])) {
+			count++;
+		} else {
+			if (invalid->len) {
+				dstr_cat(invalid, "\n");
+			}
+			dstr_cat(invalid, text ? text : "");
+		}
+		obs_data_release(item);
+	}
+	obs_data_array_release(list);
+	return count;
+}
+
+// Lists the regions that will be ignored under the regions list.
+static bool setting_mask_regions_modified(obs_properties_t *props,
+					  obs_property_t *p,
+					  obs_data_t *settings)
+{
+	UNUSED_PARAMETER(p);
+	effect_mask_region_t regions[EFFECT_MASK_MAX_REGIONS];
+	struct dstr invalid = {0};
+	parse_mask_regions(settings, regions, &invalid);
+
+	obs_property_t *error =
+		obs_properties_get(props, "effect_mask_regions_invalid");
+	if (invalid.len) {
+		struct dstr text = {0};
+		dstr_copy(&text, obs_module_text(
+			"CompositeBlurFilter.EffectMask.Regions.Invalid"));
+		dstr_cat(&text, "\n");
+		dstr_cat_dstr(&text, &invalid);
+		obs_property_set_description(error, text.array);
+		dstr_free(&text);
+	}
+	obs_property_set_visible(error, invalid.len > 0);
+	dstr_free(&invalid);
+	return true;
+}
+
 static obs_properties_t *composite_blur_properties(void *data)
 {
 	composite_blur_filter_data_t *filter = data;
@@ -1179,6 +2367,10 @@ static obs_properties_t *composite_blur_properties(void *data)
 		"",
 		"");
 
+	obs_properties_add_bool(
+		vector_blur, "vector_source_static",
+		obs_module_text("CompositeBlurFilter.VectorBlur.StaticSource"));
+
 	obs_property_t* vector_channel = obs_properties_add_list(
 		vector_blur, "vector_blur_channel",
 		obs_module_text("CompositeBlurFilter.VectorBlur.Channel"),
@@ -1230,6 +2422,25 @@ static obs_properties_t *composite_blur_properties(void *data)
 		obs_module_text("CompositeBlurFilter.VectorBlur.Smoothing"),
 		0.0, 1000.0, 0.1);
 
+	obs_property_t *vector_gradient_scale = obs_properties_add_list(
+		vector_blur, "vector_gradient_scale",
+		obs_module_text("CompositeBlurFilter.VectorBlur.GradientScale"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(vector_gradient_scale,
+				  obs_module_text(PROCESSING_SCALE_FULL_LABEL),
+				  PROCESSING_SCALE_FULL);
+	obs_property_list_add_int(vector_gradient_scale,
+				  obs_module_text(PROCESSING_SCALE_HALF_LABEL),
+				  PROCESSING_SCALE_HALF);
+	obs_property_list_add_int(
+		vector_gradient_scale,
+		obs_module_text(PROCESSING_SCALE_QUARTER_LABEL),
+		PROCESSING_SCALE_QUARTER);
+	obs_property_list_add_int(
+		vector_gradient_scale,
+		obs_module_text(PROCESSING_SCALE_EIGHTH_LABEL),
+		PROCESSING_SCALE_EIGHTH);
+
 	obs_properties_add_group(props, "vector_group",
 		obs_module_text("CompositeBlurFilter.VectorBlur"),
 		OBS_GROUP_NORMAL, vector_blur);
@@ -1244,6 +2455,45 @@ static obs_properties_t *composite_blur_properties(void *data)
 
 	obs_property_float_set_suffix(clear_threshold, "%");
 
+	obs_property_t *temporal_mode = obs_properties_add_list(
+		props, "temporal_mode",
+		obs_module_text("CompositeBlurFilter.Temporal.Mode"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(
+		temporal_mode, obs_module_text(TEMPORAL_MODE_EXPONENTIAL_LABEL),
+		TEMPORAL_MODE_EXPONENTIAL);
+	obs_property_list_add_int(temporal_mode,
+				  obs_module_text(TEMPORAL_MODE_BOX_LABEL),
+				  TEMPORAL_MODE_BOX);
+	obs_property_set_modified_callback(temporal_mode,
+					   setting_temporal_mode_modified);
+
+	obs_properties_add_int_slider(
+		props, "temporal_frames",
+		obs_module_text("CompositeBlurFilter.Temporal.Frames"), 2,
+		TEMPORAL_MAX_FRAMES, 1);
+
+	obs_property_t *temporal_history_scale = obs_properties_add_list(
+		props, "temporal_history_scale",
+		obs_module_text("CompositeBlurFilter.Temporal.HistoryScale"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(temporal_history_scale,
+				  obs_module_text(PROCESSING_SCALE_FULL_LABEL),
+				  PROCESSING_SCALE_FULL);
+	obs_property_list_add_int(temporal_history_scale,
+				  obs_module_text(PROCESSING_SCALE_HALF_LABEL),
+				  PROCESSING_SCALE_HALF);
+	obs_property_list_add_int(
+		temporal_history_scale,
+		obs_module_text(PROCESSING_SCALE_QUARTER_LABEL),
+		PROCESSING_SCALE_QUARTER);
+
+	p = obs_properties_add_bool(
+		props, "pixelate_cell_average",
+		obs_module_text("CompositeBlurFilter.Pixelate.CellAverage"));
+	obs_property_set_modified_callback(p,
+		setting_pixelate_animate_modified);
+
 	p = obs_properties_add_float_slider(
 		props, "pixelate_smoothing_pct",
 		obs_module_text("CompositeBlurFilter.Pixelate.Smoothing"), 0.0,
@@ -1304,6 +2554,9 @@ static obs_properties_t *composite_blur_properties(void *data)
 		-360.0, 360.1, 0.1);
 	obs_property_float_set_suffix(p, "deg");
 
+	obs_properties_add_bool(props, "log_step",
+				obs_module_text("CompositeBlurFilter.LogStep"));
+
 	obs_properties_t *center_coords = obs_properties_create();
 
 	p = obs_properties_add_float_slider(
@@ -1351,6 +2604,64 @@ static obs_properties_t *composite_blur_properties(void *data)
 		obs_module_text("CompositeBlurFilter.TiltShift"),
 		OBS_GROUP_NORMAL, tilt_shift_bounds);
 
+	obs_property_t *processing_scale = obs_properties_add_list(
+		props, "processing_scale",
+		obs_module_text("CompositeBlurFilter.ProcessingScale"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(processing_scale,
+				  obs_module_text(PROCESSING_SCALE_AUTO_LABEL),
+				  PROCESSING_SCALE_AUTO);
+	obs_property_list_add_int(processing_scale,
+				  obs_module_text(PROCESSING_SCALE_FULL_LABEL),
+				  PROCESSING_SCALE_FULL);
+	obs_property_list_add_int(processing_scale,
+				  obs_module_text(PROCESSING_SCALE_HALF_LABEL),
+				  PROCESSING_SCALE_HALF);
+	obs_property_list_add_int(
+		processing_scale,
+		obs_module_text(PROCESSING_SCALE_QUARTER_LABEL),
+		PROCESSING_SCALE_QUARTER);
+	obs_property_list_add_int(
+		processing_scale,
+		obs_module_text(PROCESSING_SCALE_EIGHTH_LABEL),
+		PROCESSING_SCALE_EIGHTH);
+
+	p = obs_properties_add_int_slider(
+		props, "idle_release_time",
+		obs_module_text("CompositeBlurFilter.IdleReleaseTime"), 0,
+		IDLE_RELEASE_MAX, 1);
+	obs_property_int_set_suffix(p, "s");
+	obs_property_set_long_description(
+		p, obs_module_text(
+			   "CompositeBlurFilter.IdleReleaseTime.Description"));
+
+	p = obs_properties_add_int(
+		props, "vram_budget",
+		obs_module_text("CompositeBlurFilter.VramBudget"), 0,
+		VRAM_BUDGET_MAX_MB, 256);
+	obs_property_int_set_suffix(p, " MB");
+	obs_property_set_long_description(
+		p, obs_module_text(
+			   "CompositeBlurFilter.VramBudget.Description"));
+
+	struct dstr vram_usage = {0};
+	const double mb = 1024.0 * 1024.0;
+	pthread_mutex_lock(&vram_mutex);
+	const uint64_t vram_total = vram_global_total;
+	pthread_mutex_unlock(&vram_mutex);
+	dstr_printf(&vram_usage,
+		    obs_module_text("CompositeBlurFilter.VramUsage.Format"),
+		    (double)filter->vram_total / mb,
+		    (double)filter->vram_bytes[VRAM_KIND_FRAME] / mb,
+		    (double)filter->vram_bytes[VRAM_KIND_PYRAMID] / mb,
+		    (double)filter->vram_bytes[VRAM_KIND_MASK] / mb,
+		    (double)filter->vram_bytes[VRAM_KIND_ALGORITHM] / mb,
+		    (double)filter->vram_bytes[VRAM_KIND_TEMPORAL] / mb,
+		    (double)vram_total / mb);
+	obs_properties_add_text(props, "vram_usage", vram_usage.array,
+				OBS_TEXT_INFO);
+	dstr_free(&vram_usage);
+
 	p = obs_properties_add_list(
 		props, "background",
 		obs_module_text("CompositeBlurFilter.Background"),
@@ -1386,6 +2697,10 @@ static obs_properties_t *composite_blur_properties(void *data)
 		effect_mask_list,
 		obs_module_text(EFFECT_MASK_TYPE_CIRCLE_LABEL),
 		EFFECT_MASK_TYPE_CIRCLE);
+	obs_property_list_add_int(
+		effect_mask_list,
+		obs_module_text(EFFECT_MASK_TYPE_REGIONS_LABEL),
+		EFFECT_MASK_TYPE_REGIONS);
 
 	obs_property_set_modified_callback(effect_mask_list,
 					   setting_effect_mask_modified);
@@ -1469,6 +2784,36 @@ static obs_properties_t *composite_blur_properties(void *data)
 			"CompositeBlurFilter.EffectMask.RectParameters"),
 		OBS_GROUP_NORMAL, effect_mask_rect);
 
+	obs_properties_t *effect_mask_regions = obs_properties_create();
+
+	obs_property_t *regions_list = obs_properties_add_editable_list(
+		effect_mask_regions, "effect_mask_regions_list",
+		obs_module_text("CompositeBlurFilter.EffectMask.Regions.List"),
+		OBS_EDITABLE_LIST_TYPE_STRINGS, NULL, NULL);
+	obs_property_set_long_description(
+		regions_list,
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.Regions.List.Description"));
+	obs_property_set_modified_callback(regions_list,
+					   setting_mask_regions_modified);
+
+	obs_property_t *regions_invalid = obs_properties_add_text(
+		effect_mask_regions, "effect_mask_regions_invalid", "",
+		OBS_TEXT_INFO);
+	obs_property_text_set_info_type(regions_invalid,
+					OBS_TEXT_INFO_WARNING);
+	obs_property_set_visible(regions_invalid, false);
+
+	obs_properties_add_bool(
+		effect_mask_regions, "effect_mask_regions_invert",
+		obs_module_text("CompositeBlurFilter.EffectMask.Invert"));
+
+	obs_properties_add_group(
+		props, "effect_mask_regions",
+		obs_module_text(
+			"CompositeBlurFilter.EffectMask.RegionsParameters"),
+		OBS_GROUP_NORMAL, effect_mask_regions);
+
 	obs_properties_t *effect_mask_source = obs_properties_create();
 
 	obs_properties_add_path(
@@ -1544,6 +2889,25 @@ static obs_properties_t *composite_blur_properties(void *data)
 		effect_mask_source, "effect_mask_source_invert",
 		obs_module_text("CompositeBlurFilter.EffectMask.Invert"));
 
+	obs_property_t *mask_source_scale = obs_properties_add_list(
+		effect_mask_source, "effect_mask_source_scale",
+		obs_module_text("CompositeBlurFilter.EffectMask.Source.Scale"),
+		OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+	obs_property_list_add_int(mask_source_scale,
+				  obs_module_text(PROCESSING_SCALE_FULL_LABEL),
+				  PROCESSING_SCALE_FULL);
+	obs_property_list_add_int(mask_source_scale,
+				  obs_module_text(PROCESSING_SCALE_HALF_LABEL),
+				  PROCESSING_SCALE_HALF);
+	obs_property_list_add_int(
+		mask_source_scale,
+		obs_module_text(PROCESSING_SCALE_QUARTER_LABEL),
+		PROCESSING_SCALE_QUARTER);
+
+	obs_properties_add_bool(
+		effect_mask_source, "effect_mask_source_static",
+		obs_module_text("CompositeBlurFilter.EffectMask.Source.Static"));
+
 	obs_properties_add_group(
 		props, "effect_mask_source",
 		obs_module_text(
@@ -1630,12 +2994,42 @@ static bool setting_effect_mask_source_filter_modified(obs_properties_t *props,
 	return true;
 }
 
+static bool setting_temporal_mode_modified(obs_properties_t *props,
+					   obs_property_t *p,
+					   obs_data_t *settings)
+{
+	UNUSED_PARAMETER(p);
+	const bool temporal =
+		(int)obs_data_get_int(settings, "blur_algorithm") ==
+		ALGO_TEMPORAL;
+	const int mode = (int)obs_data_get_int(settings, "temporal_mode");
+	setting_visibility("temporal_mode", temporal, props);
+	setting_visibility("temporal_current_weight",
+			   temporal && mode == TEMPORAL_MODE_EXPONENTIAL,
+			   props);
+	setting_visibility("temporal_frames",
+			   temporal && mode == TEMPORAL_MODE_BOX, props);
+	return true;
+}
+
 static bool setting_pixelate_animate_modified(obs_properties_t* props,
 	obs_property_t* p,
 	obs_data_t* settings)
 {
 	UNUSED_PARAMETER(p);
 	int pixelate_type = (int)obs_data_get_int(settings, "pixelate_type");
+	if ((int)obs_data_get_int(settings, "blur_algorithm") ==
+	    ALGO_PIXELATE) {
+		// Cell averages replace the kawase smoothing pre-pass.
+		const bool cell_average =
+			pixelate_type == PIXELATE_TYPE_SQUARE &&
+			obs_data_get_bool(settings, "pixelate_cell_average");
+		setting_visibility("pixelate_cell_average",
+				   pixelate_type == PIXELATE_TYPE_SQUARE,
+				   props);
+		setting_visibility("pixelate_smoothing_pct", !cell_average,
+				   props);
+	}
 	if (pixelate_type == PIXELATE_TYPE_VORONOI) {
 		bool animate = obs_data_get_bool(settings, "pixelate_animate");
 		setting_visibility("pixelate_time", !animate, props);
@@ -1662,32 +3056,38 @@ static bool setting_effect_mask_modified(obs_properties_t *props,
 		setting_visibility("effect_mask_source", false, props);
 		setting_visibility("effect_mask_circle", false, props);
 		setting_visibility("effect_mask_rect", false, props);
+		setting_visibility("effect_mask_regions", false, props);
 		break;
 	case EFFECT_MASK_TYPE_CROP:
 		setting_visibility("effect_mask_crop", true, props);
 		setting_visibility("effect_mask_source", false, props);
 		setting_visibility("effect_mask_circle", false, props);
 		setting_visibility("effect_mask_rect", false, props);
+		setting_visibility("effect_mask_regions", false, props);
 		break;
 	case EFFECT_MASK_TYPE_CIRCLE:
 		setting_visibility("effect_mask_crop", false, props);
 		setting_visibility("effect_mask_source", false, props);
 		setting_visibility("effect_mask_circle", true, props);
 		setting_visibility("effect_mask_rect", false, props);
+		setting_visibility("effect_mask_regions", false, props);
 		break;
 	case EFFECT_MASK_TYPE_RECT:
 		setting_visibility("effect_mask_crop", false, props);
 		setting_visibility("effect_mask_source", false, props);
 		setting_visibility("effect_mask_circle", false, props);
 		setting_visibility("effect_mask_rect", true, props);
+		setting_visibility("effect_mask_regions", false, props);
 		break;
 	case EFFECT_MASK_TYPE_SOURCE:
 		setting_visibility("effect_mask_crop", false, props);
 		setting_visibility("effect_mask_source", true, props);
 		setting_visibility("effect_mask_circle", false, props);
 		setting_visibility("effect_mask_rect", false, props);
+		setting_visibility("effect_mask_regions", false, props);
 		setting_visibility("effect_mask_source_file", false, props);
 		setting_visibility("effect_mask_source_source", true, props);
+		setting_visibility("effect_mask_source_static", true, props);
 		{
 			obs_property_t *prop =
 				obs_properties_get(props, "effect_mask_source");
@@ -1702,8 +3102,10 @@ static bool setting_effect_mask_modified(obs_properties_t *props,
 		setting_visibility("effect_mask_source", true, props);
 		setting_visibility("effect_mask_circle", false, props);
 		setting_visibility("effect_mask_rect", false, props);
+		setting_visibility("effect_mask_regions", false, props);
 		setting_visibility("effect_mask_source_file", true, props);
 		setting_visibility("effect_mask_source_source", false, props);
+		setting_visibility("effect_mask_source_static", false, props);
 		{
 			obs_property_t *prop =
 				obs_properties_get(props, "effect_mask_source");
@@ -1713,6 +3115,13 @@ static bool setting_effect_mask_modified(obs_properties_t *props,
 					"CompositeBlurFilter.EffectMask.ImageParameters"));
 		}
 		break;
+	case EFFECT_MASK_TYPE_REGIONS:
+		setting_visibility("effect_mask_crop", false, props);
+		setting_visibility("effect_mask_source", false, props);
+		setting_visibility("effect_mask_circle", false, props);
+		setting_visibility("effect_mask_rect", false, props);
+		setting_visibility("effect_mask_regions", true, props);
+		break;
 	}
 	return true;
 }
@@ -1735,6 +3144,9 @@ static void effect_mask_load_effect(composite_blur_filter_data_t *filter)
 	case EFFECT_MASK_TYPE_IMAGE:
 		load_source_mask_effect(filter);
 		break;
+	case EFFECT_MASK_TYPE_REGIONS:
+		load_regions_mask_effect(filter);
+		break;
 	}
 }
 
@@ -1750,11 +3162,15 @@ static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 		setting_visibility("radius", true, props);
 		setting_visibility("temporal_current_weight", false, props);
 		setting_visibility("temporal_clear_threshold", false, props);
+		setting_visibility("temporal_mode", false, props);
+		setting_visibility("temporal_frames", false, props);
+		setting_visibility("temporal_history_scale", false, props);
 		setting_visibility("passes", false, props);
 		setting_visibility("kawase_passes", false, props);
 		setting_visibility("blur_type", true, props);
 		setting_visibility("pixelate_type", false, props);
 		setting_visibility("pixelate_smoothing_pct", false, props);
+		setting_visibility("pixelate_cell_average", false, props);
 		setting_visibility("pixelate_rotation", false, props);
 		setting_visibility("pixelate_origin_x", false, props);
 		setting_visibility("pixelate_origin_y", false, props);
@@ -1771,17 +3187,22 @@ static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 		setting_visibility("radius", true, props);
 		setting_visibility("temporal_current_weight", false, props);
 		setting_visibility("temporal_clear_threshold", false, props);
+		setting_visibility("temporal_mode", false, props);
+		setting_visibility("temporal_frames", false, props);
+		setting_visibility("temporal_history_scale", false, props);
 		setting_visibility("kawase_passes", false, props);
 		setting_visibility("passes", true, props);
 		setting_visibility("blur_type", true, props);
 		setting_visibility("pixelate_type", false, props);
 		setting_visibility("pixelate_smoothing_pct", false, props);
+		setting_visibility("pixelate_cell_average", false, props);
 		setting_visibility("pixelate_rotation", false, props);
 		setting_visibility("pixelate_origin_x", false, props);
 		setting_visibility("pixelate_origin_y", false, props);
 		setting_visibility("pixelate_animate", false, props);
 		setting_visibility("pixelate_time", false, props);
 		setting_visibility("pixelate_animation_speed", false, props);
+		setting_visibility("log_step", false, props);
 
 		set_blur_radius_settings(
 			obs_module_text("CompositeBlurFilter.Radius"), 0.0f,
@@ -1792,17 +3213,22 @@ static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 		setting_visibility("radius", false, props);
 		setting_visibility("temporal_current_weight", false, props);
 		setting_visibility("temporal_clear_threshold", false, props);
+		setting_visibility("temporal_mode", false, props);
+		setting_visibility("temporal_frames", false, props);
+		setting_visibility("temporal_history_scale", false, props);
 		setting_visibility("passes", false, props);
 		setting_visibility("kawase_passes", true, props);
 		setting_visibility("blur_type", false, props);
 		setting_visibility("pixelate_type", false, props);
 		setting_visibility("pixelate_smoothing_pct", false, props);
+		setting_visibility("pixelate_cell_average", false, props);
 		setting_visibility("pixelate_rotation", false, props);
 		setting_visibility("pixelate_origin_x", false, props);
 		setting_visibility("pixelate_origin_y", false, props);
 		setting_visibility("pixelate_animate", false, props);
 		setting_visibility("pixelate_time", false, props);
 		setting_visibility("pixelate_animation_speed", false, props);
+		setting_visibility("log_step", false, props);
 		set_dual_kawase_blur_types(props);
 		obs_data_set_int(settings, "blur_type", TYPE_AREA);
 		settings_blur_area(props, settings);
@@ -1811,6 +3237,9 @@ static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 		setting_visibility("radius", true, props);
 		setting_visibility("temporal_current_weight", false, props);
 		setting_visibility("temporal_clear_threshold", false, props);
+		setting_visibility("temporal_mode", false, props);
+		setting_visibility("temporal_frames", false, props);
+		setting_visibility("temporal_history_scale", false, props);
 		setting_visibility("passes", false, props);
 		setting_visibility("kawase_passes", false, props);
 		setting_visibility("blur_type", false, props);
@@ -1822,6 +3251,7 @@ static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 		setting_visibility("pixelate_animate", true, props);
 		setting_visibility("pixelate_time", true, props);
 		setting_visibility("pixelate_animation_speed", true, props);
+		setting_visibility("log_step", false, props);
 		set_blur_radius_settings(
 			obs_module_text(
 				"CompositeBlurFilter.Pixelate.PixelSize"),
@@ -1840,14 +3270,19 @@ static bool setting_blur_algorithm_modified(void *data, obs_properties_t *props,
 		setting_visibility("blur_type", false, props);
 		setting_visibility("pixelate_type", false, props);
 		setting_visibility("pixelate_smoothing_pct", false, props);
+		setting_visibility("pixelate_cell_average", false, props);
 		setting_visibility("pixelate_rotation", false, props);
 		setting_visibility("pixelate_origin_x", false, props);
 		setting_visibility("pixelate_origin_y", false, props);
 		setting_visibility("pixelate_animate", false, props);
 		setting_visibility("pixelate_time", false, props);
 		setting_visibility("pixelate_animation_speed", false, props);
+		setting_visibility("log_step", false, props);
+		setting_visibility("temporal_history_scale", true, props);
+		setting_temporal_mode_modified(props, p, settings);
 		break;
 	}
+	setting_processing_scale_visibility(props, settings);
 	return true;
 }
 
@@ -1858,14 +3293,15 @@ static bool setting_blur_types_modified(void *data, obs_properties_t *props,
 	//UNUSED_PARAMETER(data);
 	composite_blur_filter_data_t* filter = data;
 	int blur_type = (int)obs_data_get_int(settings, "blur_type");
+	setting_processing_scale_visibility(props, settings);
 	if (blur_type == TYPE_AREA) {
 		return settings_blur_area(props, settings);
 	} else if (blur_type == TYPE_DIRECTIONAL) {
-		return settings_blur_directional(props);
+		return settings_blur_directional(props, settings);
 	} else if (blur_type == TYPE_ZOOM) {
 		return settings_blur_zoom(props);
 	} else if (blur_type == TYPE_MOTION) {
-		return settings_blur_directional(props);
+		return settings_blur_directional(props, settings);
 	} else if (blur_type == TYPE_TILTSHIFT) {
 		return settings_blur_tilt_shift(props);
 	} else if (blur_type == TYPE_VECTOR) {
@@ -1874,6 +3310,17 @@ static bool setting_blur_types_modified(void *data, obs_properties_t *props,
 	return true;
 }
 
+static void setting_processing_scale_visibility(obs_properties_t *props,
+						obs_data_t *settings)
+{
+	int algorithm = (int)obs_data_get_int(settings, "blur_algorithm");
+	int blur_type = (int)obs_data_get_int(settings, "blur_type");
+	bool visible = algorithm == ALGO_BOX ||
+		       algorithm == ALGO_DUAL_KAWASE ||
+		       (algorithm == ALGO_GAUSSIAN && blur_type != TYPE_VECTOR);
+	setting_visibility("processing_scale", visible, props);
+}
+
 static void setting_visibility(const char *prop_name, bool visible,
 			       obs_properties_t *props)
 {
@@ -1897,6 +3344,7 @@ static bool settings_blur_area(obs_properties_t *props, obs_data_t *settings)
 	int algorithm = (int)obs_data_get_int(settings, "blur_algorithm");
 	setting_visibility("radius", algorithm != ALGO_DUAL_KAWASE, props);
 	setting_visibility("angle", false, props);
+	setting_visibility("log_step", false, props);
 	setting_visibility("center_coordinate", false, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", false, props);
@@ -1904,10 +3352,13 @@ static bool settings_blur_area(obs_properties_t *props, obs_data_t *settings)
 	return true;
 }
 
-static bool settings_blur_directional(obs_properties_t *props)
+static bool settings_blur_directional(obs_properties_t *props,
+				      obs_data_t *settings)
 {
+	int algorithm = (int)obs_data_get_int(settings, "blur_algorithm");
 	setting_visibility("radius", true, props);
 	setting_visibility("angle", true, props);
+	setting_visibility("log_step", algorithm == ALGO_GAUSSIAN, props);
 	setting_visibility("center_coordinate", false, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", false, props);
@@ -1919,6 +3370,7 @@ static bool settings_blur_zoom(obs_properties_t *props)
 {
 	setting_visibility("radius", true, props);
 	setting_visibility("angle", false, props);
+	setting_visibility("log_step", false, props);
 	setting_visibility("center_coordinate", true, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", false, props);
@@ -1930,6 +3382,7 @@ static bool settings_blur_tilt_shift(obs_properties_t *props)
 {
 	setting_visibility("radius", true, props);
 	setting_visibility("angle", false, props);
+	setting_visibility("log_step", false, props);
 	setting_visibility("center_coordinate", false, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", true, props);
@@ -1941,6 +3394,7 @@ static bool settings_blur_vector(obs_properties_t* props, composite_blur_filter_
 {
 	setting_visibility("radius", false , props);
 	setting_visibility("angle", false, props);
+	setting_visibility("log_step", false, props);
 	setting_visibility("center_coordinate", false, props);
 	setting_visibility("background", true, props);
 	setting_visibility("tilt_shift_bounds", false, props);
@@ -1990,41 +3444,36 @@ static void composite_blur_video_tick(void *data, float seconds)
 	else {
 		filter->time = filter->pixelate_animation_time;
 	}
-	obs_source_t *target = obs_filter_get_target(filter->context);
-	if (!target) {
-		return;
+	// Hidden, inactive or disabled instances stop rendering, so free
+	// their targets after a while.
+	filter->idle_time += seconds;
+	if (filter->idle_release_time > 0 && !filter->idle_released &&
+	    filter->idle_time > (float)filter->idle_release_time) {
+		release_render_targets(filter);
+		filter->idle_released = true;
 	}
 
-	if (filter->has_mask_source && !filter->mask_source_source) {
-		obs_source_t* mask_source =
-			filter->has_mask_source
-			? obs_get_source_by_name(filter->mask_source_name.array)
-			: NULL;
-
-		if (mask_source) {
-			filter->mask_source_source =
-				obs_source_get_weak_source(mask_source);
-			obs_source_release(mask_source);
-		}
-		else {
-			filter->mask_source_source = NULL;
-		}
+	filter->vram_measure_time += seconds;
+	if (filter->vram_measure_time >= 1.0f) {
+		filter->vram_measure_time = 0.0f;
+		vram_measure(filter);
+		vram_enforce_budget(filter);
 	}
 
-	if (filter->has_background_source && !filter->background) {
-		obs_source_t* background_source =
-			filter->has_background_source
-			? obs_get_source_by_name(filter->background_source_name.array)
-			: NULL;
+	if (os_atomic_exchange_bool(&filter->sources_dirty, false)) {
+		sync_named_source(filter, &filter->mask_source_source,
+				  filter->has_mask_source,
+				  &filter->mask_source_name,
+				  "effect_mask_source_source");
+		sync_named_source(filter, &filter->background,
+				  filter->has_background_source,
+				  &filter->background_source_name,
+				  "background");
+	}
 
-		if (background_source) {
-			filter->background =
-				obs_source_get_weak_source(background_source);
-			obs_source_release(background_source);
-		}
-		else {
-			filter->background = NULL;
-		}
+	obs_source_t *target = obs_filter_get_target(filter->context);
+	if (!target) {
+		return;
 	}
 
 	if (filter->hotkey == OBS_INVALID_HOTKEY_PAIR_ID) {
@@ -2057,29 +3506,33 @@ static void composite_blur_video_tick(void *data, float seconds)
 	}
 	const uint32_t width = (uint32_t)obs_source_get_base_width(target);
 	const uint32_t height = (uint32_t)obs_source_get_base_height(target);
-	if(filter->width != width || filter->height != height) {
+	if(filter->full_width != width || filter->full_height != height) {
 		filter->width = (uint32_t)obs_source_get_base_width(target);
 		filter->height = (uint32_t)obs_source_get_base_height(target);
+		filter->full_width = filter->width;
+		filter->full_height = filter->height;
 		filter->uv_size.x = (float)filter->width;
 		filter->uv_size.y = (float)filter->height;
 	}
-	obs_data_t* settings = obs_source_get_settings(filter->context);
-	if (filter->width > 0 &&
-		(float)obs_data_get_double(settings, "pixelate_origin_x") < -1.e8) {
+	if (filter->width > 0 && !filter->pixelate_origin_set) {
+		obs_data_t *settings =
+			obs_source_get_settings(filter->context);
 		obs_data_set_double(settings, "pixelate_origin_x", (double)width / 2.0);
 		obs_data_set_double(settings, "pixelate_origin_y",
 			(double)height / 2.0);
 		obs_data_set_double(settings, "center_x", (double)width / 2.0);
 		obs_data_set_double(settings, "center_y", (double)height / 2.0);
-		filter->center_x = (float)width / 2.0f;
-		filter->center_y = (float)height / 2.0f;
+		filter->center_x =
+			(float)width / 2.0f / (float)filter->processing_scale;
+		filter->center_y =
+			(float)height / 2.0f / (float)filter->processing_scale;
 
 		filter->pixelate_tessel_center.x = (float)width / 2.0f;
 		filter->pixelate_tessel_center.y = (float)height / 2.0f;
+		filter->pixelate_origin_set = true;
+		obs_data_release(settings);
 	}
 
-	obs_data_release(settings);
-
 	filter->rendered = false;
 }
 
@@ -2106,9 +3559,291 @@ static void composite_blur_reload_effect(composite_blur_filter_data_t *filter)
 		load_composite_effect(filter);
 		load_mix_effect(filter);
 		load_output_effect(filter);
+		load_resample_effect(filter);
+		load_stencil_effect(filter);
+	}
+
+	obs_data_release(settings);
+}
+
+static void destroy_texrender(gs_texrender_t **render)
+{
+	if (*render) {
+		gs_texrender_destroy(*render);
+		*render = NULL;
+	}
+}
+
+static void destroy_effect(gs_effect_t **effect)
+{
+	if (*effect) {
+		gs_effect_destroy(*effect);
+		*effect = NULL;
+	}
+}
+
+static void release_pixelate_resources(composite_blur_filter_data_t *filter)
+{
+	destroy_texrender(&filter->pixelate_cells_texrender);
+	destroy_texrender(&filter->voronoi_seed_map);
+	destroy_texrender(&filter->voronoi_seed_map2);
+	destroy_texrender(&filter->pixelate_cell_map);
+	filter->pixelate_cell_map_valid = false;
+	filter->voronoi_seed_map_valid = false;
+	destroy_effect(&filter->pixelate_effect);
+	destroy_effect(&filter->pixelate_cells_effect);
+	destroy_effect(&filter->voronoi_jfa_effect);
+}
+
+static void release_vector_resources(composite_blur_filter_data_t *filter)
+{
+	destroy_texrender(&filter->vb_smoothed_gradient);
+	destroy_texrender(&filter->vb_source_render);
+	destroy_effect(&filter->gradient_effect);
+	destroy_effect(&filter->gv_effect);
+	filter->vb_gradient_dirty = true;
+}
+
+static void release_kernel_resources(composite_blur_filter_data_t *filter)
+{
+	if (filter->kernel_texture) {
+		gs_texture_destroy(filter->kernel_texture);
+		filter->kernel_texture = NULL;
+	}
+	// Forces update_gaussian to rebuild the kernel on the next update.
+	filter->radius_last = -1.0f;
+	filter->last_vector_blur_amount = -999999.0f;
+}
+
+static void release_composite_resources(composite_blur_filter_data_t *filter)
+{
+	destroy_texrender(&filter->background_texrender);
+	destroy_texrender(&filter->composite_render);
+}
+
+/*
+ *  Frees the resources owned by algorithm stages the current settings
+ *  no longer use, e.g. the pixelate cell maps after switching to
+ *  gaussian. Each stage recreates its resources when selected again.
+ */
+static void release_unused_resources(composite_blur_filter_data_t *filter)
+{
+	const bool gaussian = filter->blur_algorithm == ALGO_GAUSSIAN;
+	obs_enter_graphics();
+	if (filter->blur_algorithm != ALGO_PIXELATE) {
+		release_pixelate_resources(filter);
+	}
+	if (!gaussian || filter->blur_type != TYPE_VECTOR) {
+		release_vector_resources(filter);
+	}
+	// Only the box area blur and the vector gradient run through the
+	// render graph.
+	if (!(gaussian && filter->blur_type == TYPE_VECTOR) &&
+	    !(filter->blur_algorithm == ALGO_BOX &&
+	      filter->blur_type == TYPE_AREA)) {
+		render_pool_free(&filter->graph_pool);
+	}
+	if (!gaussian) {
+		release_kernel_resources(filter);
+	}
+	if (filter->blur_algorithm != ALGO_TEMPORAL) {
+		temporal_free_history(filter);
+	}
+	if (!filter->has_background_source) {
+		release_composite_resources(filter);
+	}
+	obs_leave_graphics();
+}
+
+/*
+ *  Frees every render target of an idle instance. Effects and the
+ *  gaussian kernel are kept, as only a settings update rebuilds the
+ *  kernel. Targets are recreated by the next render and cached results
+ *  (mask channel, vector gradient) are marked dirty.
+ */
+static void release_render_targets(composite_blur_filter_data_t *filter)
+{
+	obs_enter_graphics();
+	destroy_texrender(&filter->input_texrender);
+	destroy_texrender(&filter->output_texrender);
+	destroy_texrender(&filter->render);
+	destroy_texrender(&filter->render2);
+	destroy_texrender(&filter->processing_input_texrender);
+	destroy_texrender(&filter->pixelate_cells_texrender);
+	destroy_texrender(&filter->voronoi_seed_map);
+	destroy_texrender(&filter->voronoi_seed_map2);
+	destroy_texrender(&filter->pixelate_cell_map);
+	filter->pixelate_cell_map_valid = false;
+	filter->voronoi_seed_map_valid = false;
+	render_pool_free(&filter->graph_pool);
+	destroy_texrender(&filter->vb_smoothed_gradient);
+	destroy_texrender(&filter->vb_source_render);
+	filter->vb_gradient_dirty = true;
+	destroy_texrender(&filter->mask_source_render);
+	destroy_texrender(&filter->mask_channel_render);
+	filter->mask_channel_dirty = true;
+	destroy_texrender(&filter->stencil_target);
+	destroy_texrender(&filter->stencil_coverage);
+	destroy_texrender(&filter->stencil_zero);
+	destroy_texrender(&filter->stencil_one);
+	if (filter->stencil_zs) {
+		gs_zstencil_destroy(filter->stencil_zs);
+		filter->stencil_zs = NULL;
+	}
+	filter->stencil_valid = false;
+	release_composite_resources(filter);
+	temporal_free_history(filter);
+	pyramid_cache_free(filter->pyramids);
+	obs_leave_graphics();
+}
+
+/*
+ *  Refreshes the per kind GPU memory totals of this instance and its
+ *  share of the global total. The shared image mask cache is not
+ *  counted, as it is not owned by any one instance.
+ */
+static void vram_measure(composite_blur_filter_data_t *filter)
+{
+	uint64_t bytes[VRAM_KIND_COUNT] = {0};
+
+	obs_enter_graphics();
+	bytes[VRAM_KIND_FRAME] =
+		texrender_vram_bytes(filter->input_texrender) +
+		texrender_vram_bytes(filter->output_texrender) +
+		texrender_vram_bytes(filter->render) +
+		texrender_vram_bytes(filter->render2) +
+		render_pool_vram_bytes(&filter->graph_pool) +
+		texrender_vram_bytes(filter->processing_input_texrender) +
+		texrender_vram_bytes(filter->background_texrender) +
+		texrender_vram_bytes(filter->composite_render);
+
+	for (size_t i = 0; i < PYRAMID_CACHE_SIZE; i++) {
+		for (int j = 0; j <= PYRAMID_MAX_LEVELS; j++) {
+			bytes[VRAM_KIND_PYRAMID] += texrender_vram_bytes(
+				filter->pyramids[i].level[j]);
+		}
+	}
+
+	bytes[VRAM_KIND_MASK] =
+		texrender_vram_bytes(filter->mask_source_render) +
+		texrender_vram_bytes(filter->mask_channel_render) +
+		texrender_vram_bytes(filter->stencil_target) +
+		texrender_vram_bytes(filter->stencil_coverage) +
+		texrender_vram_bytes(filter->stencil_zero) +
+		texrender_vram_bytes(filter->stencil_one);
+	if (filter->stencil_zs) {
+		// GS_Z24_S8
+		bytes[VRAM_KIND_MASK] += (uint64_t)filter->stencil_width *
+					 filter->stencil_height * 4;
+	}
+
+	bytes[VRAM_KIND_ALGORITHM] =
+		texture_vram_bytes(filter->kernel_texture) +
+		texrender_vram_bytes(filter->vb_smoothed_gradient) +
+		texrender_vram_bytes(filter->vb_source_render) +
+		texrender_vram_bytes(filter->pixelate_cells_texrender) +
+		texrender_vram_bytes(filter->voronoi_seed_map) +
+		texrender_vram_bytes(filter->voronoi_seed_map2) +
+		texrender_vram_bytes(filter->pixelate_cell_map);
+
+	bytes[VRAM_KIND_TEMPORAL] =
+		texrender_vram_bytes(filter->temporal_history) +
+		texrender_vram_bytes(filter->temporal_sum) +
+		texrender_vram_bytes(filter->temporal_sum2) +
+		texrender_vram_bytes(filter->temporal_newest);
+	for (int i = 0; i < TEMPORAL_MAX_FRAMES; i++) {
+		bytes[VRAM_KIND_TEMPORAL] +=
+			texrender_vram_bytes(filter->temporal_ring[i]);
+	}
+	obs_leave_graphics();
+
+	uint64_t total = 0;
+	for (int i = 0; i < VRAM_KIND_COUNT; i++) {
+		filter->vram_bytes[i] = bytes[i];
+		total += bytes[i];
+	}
+
+	if (total != filter->vram_total) {
+		blog(LOG_DEBUG, "[Composite Blur] '%s' holds %.1f MB of VRAM",
+		     obs_source_get_name(filter->context),
+		     (double)total / (1024.0 * 1024.0));
+	}
+
+	const bool scalable = processing_scale_supported(filter);
+	pthread_mutex_lock(&vram_mutex);
+	vram_global_total = vram_global_total - filter->vram_total + total;
+	if (filter->vram_scalable) {
+		vram_scalable_instances--;
+		vram_scalable_total -= filter->vram_total;
+	}
+	if (scalable) {
+		vram_scalable_instances++;
+		vram_scalable_total += total;
+	}
+	pthread_mutex_unlock(&vram_mutex);
+	filter->vram_total = total;
+	filter->vram_scalable = scalable;
+}
+
+/*
+ *  While all instances together hold more than the budget, scalable
+ *  instances holding at least the average share of the scalable ones
+ *  halve their processing resolution one step at a time. Instances
+ *  already at full resolution by necessity (pixelate, temporal,
+ *  vector) or at the lowest scale can't free anything this way, so
+ *  they are left out. A step is undone once the memory it would take
+ *  back (at most 3x the current usage) fits the budget.
+ */
+static void vram_enforce_budget(composite_blur_filter_data_t *filter)
+{
+	pthread_mutex_lock(&vram_mutex);
+	const uint64_t total = vram_global_total;
+	const uint64_t budget = vram_global_budget;
+	const uint64_t scalable_total = vram_scalable_total;
+	const int scalable_instances = vram_scalable_instances;
+	pthread_mutex_unlock(&vram_mutex);
+
+	if (!filter->vram_scalable) {
+		// The shift has no effect on this algorithm, drop it quietly
+		// so switching back starts from the configured scale.
+		filter->vram_scale_shift = 0;
+		return;
+	}
+
+	int shift = filter->vram_scale_shift;
+	if (budget == 0) {
+		shift = 0;
+	} else if (total > budget) {
+		if (shift < VRAM_MAX_SCALE_SHIFT &&
+		    filter->processing_scale < PROCESSING_SCALE_EIGHTH &&
+		    filter->vram_total * (uint64_t)scalable_instances >=
+			    scalable_total) {
+			shift++;
+		}
+	} else if (shift > 0 && total + filter->vram_total * 3 < budget) {
+		shift--;
+	}
+
+	if (shift == filter->vram_scale_shift) {
+		return;
 	}
+	blog(LOG_DEBUG,
+	     "[Composite Blur] VRAM %.1f of %.1f MB, '%s' (%.1f MB) %s "
+	     "processing resolution",
+	     (double)total / (1024.0 * 1024.0),
+	     (double)budget / (1024.0 * 1024.0),
+	     obs_source_get_name(filter->context),
+	     (double)filter->vram_total / (1024.0 * 1024.0),
+	     shift > filter->vram_scale_shift ? "lowers" : "restores");
+	filter->vram_scale_shift = shift;
 
+	obs_data_t *settings = obs_source_get_settings(filter->context);
+	update_processing_scale(filter, settings);
 	obs_data_release(settings);
+	// The gaussian kernel is sampled from the scaled radius.
+	if (filter->update) {
+		filter->update(filter);
+	}
 }
 
 static void load_composite_effect(composite_blur_filter_data_t *filter)
@@ -2321,6 +4056,43 @@ static void load_circle_mask_effect(composite_blur_filter_data_t *filter)
 	}
 }
 
+static void load_regions_mask_effect(composite_blur_filter_data_t *filter)
+{
+	if (filter->effect_mask_effect != NULL) {
+		obs_enter_graphics();
+		gs_effect_destroy(filter->effect_mask_effect);
+		filter->effect_mask_effect = NULL;
+		obs_leave_graphics();
+	}
+
+	filter->effect_mask_effect = load_shader_effect(
+		filter->effect_mask_effect, "/shaders/effect_mask_regions.effect");
+	if (filter->effect_mask_effect) {
+		size_t effect_count =
+			gs_effect_get_num_params(filter->effect_mask_effect);
+		for (size_t effect_index = 0; effect_index < effect_count;
+		     effect_index++) {
+			gs_eparam_t *param = gs_effect_get_param_by_idx(
+				filter->effect_mask_effect, effect_index);
+			struct gs_effect_param_info info;
+			gs_effect_get_param_info(param, &info);
+			if (strcmp(info.name, "filtered_image") == 0) {
+				filter->param_filtered_image = param;
+			} else if (strcmp(info.name, "uv_scale") == 0) {
+				filter->param_mask_regions_uv_scale = param;
+			} else if (strcmp(info.name, "region_shape") == 0) {
+				filter->param_mask_regions_shape = param;
+			} else if (strcmp(info.name, "region_params") == 0) {
+				filter->param_mask_regions_params = param;
+			} else if (strcmp(info.name, "region_count") == 0) {
+				filter->param_mask_regions_count = param;
+			} else if (strcmp(info.name, "inv") == 0) {
+				filter->param_mask_regions_inv = param;
+			}
+		}
+	}
+}
+
 static void load_mix_effect(composite_blur_filter_data_t *filter)
 {
 	if (filter->mix_effect != NULL) {
@@ -2401,6 +4173,51 @@ static void load_output_effect(composite_blur_filter_data_t *filter)
 			gs_effect_get_param_info(param, &info);
 			if (strcmp(info.name, "output_image") == 0) {
 				filter->param_output_image = param;
+			} else if (strcmp(info.name, "linear_input") == 0) {
+				filter->param_output_linear = param;
+			}
+		}
+	}
+}
+
+static void load_stencil_effect(composite_blur_filter_data_t *filter)
+{
+	if (filter->stencil_effect != NULL) {
+		obs_enter_graphics();
+		gs_effect_destroy(filter->stencil_effect);
+		filter->stencil_effect = NULL;
+		obs_leave_graphics();
+	}
+
+	filter->stencil_effect = load_shader_effect(
+		filter->stencil_effect, "/shaders/stencil_mask.effect");
+	pyramid_effect_bind(&filter->stencil_box, filter->stencil_effect);
+}
+
+static void load_resample_effect(composite_blur_filter_data_t *filter)
+{
+	if (filter->resample_effect != NULL) {
+		obs_enter_graphics();
+		gs_effect_destroy(filter->resample_effect);
+		filter->resample_effect = NULL;
+		obs_leave_graphics();
+	}
+
+	filter->resample_effect = load_shader_effect(
+		filter->resample_effect, "/shaders/resample.effect");
+	if (filter->resample_effect) {
+		size_t effect_count =
+			gs_effect_get_num_params(filter->resample_effect);
+		for (size_t effect_index = 0; effect_index < effect_count;
+		     effect_index++) {
+			gs_eparam_t *param = gs_effect_get_param_by_idx(
+				filter->resample_effect, effect_index);
+			struct gs_effect_param_info info;
+			gs_effect_get_param_info(param, &info);
+			if (strcmp(info.name, "source_size") == 0) {
+				filter->param_resample_source_size = param;
+			} else if (strcmp(info.name, "scale") == 0) {
+				filter->param_resample_scale = param;
 			}
 		}
 	}
@@ -5,12 +5,14 @@
 #include <util/dstr.h>
 #include <util/darray.h>
 #include <util/platform.h>
-#include <graphics/image-file.h>
 
 #include <stdio.h>
 
 #include "version.h"
 #include "obs-utils.h"
+#include "blur/pyramid.h"
+#include "image-mask-cache.h"
+#include "render-graph.h"
 
 #define PLUGIN_INFO                                                                                                 \
 	"<a href=\"https://github.com/finitesingularity/obs-composite-blur/\">Composite Blur</a> (" PROJECT_VERSION \
@@ -71,6 +73,13 @@
 #define EFFECT_MASK_TYPE_SOURCE_LABEL "CompositeBlurFilter.EffectMask.Source"
 #define EFFECT_MASK_TYPE_IMAGE 5
 #define EFFECT_MASK_TYPE_IMAGE_LABEL "CompositeBlurFilter.EffectMask.Image"
+#define EFFECT_MASK_TYPE_REGIONS 6
+#define EFFECT_MASK_TYPE_REGIONS_LABEL "CompositeBlurFilter.EffectMask.Regions"
+
+// Must match MAX_REGIONS in effect_mask_regions.effect
+#define EFFECT_MASK_MAX_REGIONS 16
+#define EFFECT_MASK_REGION_RECT 0
+#define EFFECT_MASK_REGION_CIRCLE 1
 
 #define EFFECT_MASK_SOURCE_FILTER_ALPHA 0
 #define EFFECT_MASK_SOURCE_FILTER_ALPHA_LABEL \
@@ -95,6 +104,52 @@
 #define GRADIENT_TYPE_CENTRAL_LIMIT_DIFF_LABEL \
 	"CompositeBlurFilter.VectorBlur.GradientType.CentralLimitDifference"
 
+#define PROCESSING_SCALE_AUTO 0
+#define PROCESSING_SCALE_AUTO_LABEL "CompositeBlurFilter.ProcessingScale.Auto"
+#define PROCESSING_SCALE_FULL 1
+#define PROCESSING_SCALE_FULL_LABEL "CompositeBlurFilter.ProcessingScale.Full"
+#define PROCESSING_SCALE_HALF 2
+#define PROCESSING_SCALE_HALF_LABEL "CompositeBlurFilter.ProcessingScale.Half"
+#define PROCESSING_SCALE_QUARTER 4
+#define PROCESSING_SCALE_QUARTER_LABEL \
+	"CompositeBlurFilter.ProcessingScale.Quarter"
+#define PROCESSING_SCALE_EIGHTH 8
+#define PROCESSING_SCALE_EIGHTH_LABEL \
+	"CompositeBlurFilter.ProcessingScale.Eighth"
+
+// Seconds without a render before an instance frees its render
+// targets. 0 keeps them allocated.
+#define IDLE_RELEASE_DEFAULT 10
+#define IDLE_RELEASE_MAX 300
+
+// GPU memory accounting kinds, see vram_measure.
+#define VRAM_KIND_FRAME 0
+#define VRAM_KIND_PYRAMID 1
+#define VRAM_KIND_MASK 2
+#define VRAM_KIND_ALGORITHM 3
+#define VRAM_KIND_TEMPORAL 4
+#define VRAM_KIND_COUNT 5
+#define VRAM_BUDGET_MAX_MB 65536
+// Largest number of processing scale halvings the budget may add.
+#define VRAM_MAX_SCALE_SHIFT 3
+
+// Minimum blur extent, in processing pixels, that auto processing
+// scale will leave after reducing resolution.
+#define PROCESSING_SCALE_AUTO_MIN_RADIUS 8.0f
+
+// Largest fraction of the frame a mask region of interest may cover
+// before the blur falls back to full frame passes. Above this the
+// crop and composite passes cost more than they save.
+#define ROI_MAX_COVERAGE 0.5f
+
+#define TEMPORAL_MODE_EXPONENTIAL 0
+#define TEMPORAL_MODE_EXPONENTIAL_LABEL \
+	"CompositeBlurFilter.Temporal.Mode.Exponential"
+#define TEMPORAL_MODE_BOX 1
+#define TEMPORAL_MODE_BOX_LABEL "CompositeBlurFilter.Temporal.Mode.Box"
+
+#define TEMPORAL_MAX_FRAMES 30
+
 #define GRADIENT_CHANNEL_RED 0
 #define GRADIENT_CHANNEL_RED_LABEL \
 	"CompositeBlurFilter.VectorBlur.Channel.Red"
@@ -116,6 +171,19 @@
 
 typedef DARRAY(float) fDarray;
 
+// One entry of the regions mask. Positions and sizes are percentages
+// of the frame like the single rectangle and circle masks, circles use
+// width as their radius.
+struct effect_mask_region {
+	int type;
+	float center_x;
+	float center_y;
+	float width;
+	float height;
+	float feathering;
+};
+typedef struct effect_mask_region effect_mask_region_t;
+
 struct composite_blur_filter_data;
 typedef struct composite_blur_filter_data composite_blur_filter_data_t;
 
@@ -128,11 +196,27 @@ struct composite_blur_filter_data {
 	gs_effect_t *effect_2;
 	gs_effect_t *composite_effect;
 	gs_effect_t *pixelate_effect;
+	gs_effect_t *pixelate_cells_effect;
+	gs_effect_t *voronoi_jfa_effect;
 	gs_effect_t *mix_effect;
 	gs_effect_t *effect_mask_effect;
 	gs_effect_t *output_effect;
 	gs_effect_t *gradient_effect;
 	gs_effect_t *gv_effect;
+	gs_effect_t *resample_effect;
+	gs_effect_t *stencil_effect;
+	// Pyramid bindings of effect_2 (while it holds the kawase down
+	// sample effect) and of stencil_effect.
+	pyramid_effect_t kawase_down;
+	pyramid_effect_t stencil_box;
+	// Dual kawase up sample parameters, set once per pass.
+	effect_param_t param_kawase_image;
+	effect_param_t param_kawase_base_image;
+	effect_param_t param_kawase_mix_ratio;
+	effect_param_t param_kawase_texel_step;
+	// dither_strength of whichever effect is loaded into effect, bound
+	// by every loader of effect.
+	effect_param_t param_dither_strength;
 
 	// Render pipeline
 	bool input_rendered;
@@ -142,13 +226,61 @@ struct composite_blur_filter_data {
 	// Frame Buffers
 	gs_texrender_t *render;
 	gs_texrender_t *render2;
+	// Passes declared through the render graph (box area blur, vector
+	// gradient) take transient targets from graph_pool, which only
+	// backs this graph.
+	render_pool_t graph_pool;
+	render_graph_t graph;
 	gs_texrender_t *background_texrender;
 	// Renderer for composite render step
 	gs_texrender_t *composite_render;
 
-	// Renderers for vector blur
-	gs_texrender_t* vb_gradient;
+	// Seconds since the last render, and whether the render targets
+	// were freed for being idle. Targets are rebuilt lazily.
+	float idle_time;
+	int idle_release_time;
+	bool idle_released;
+
+	// GPU memory held by this instance per VRAM_KIND, refreshed once
+	// a second from video_tick. vram_scale_shift halves the processing
+	// resolution while the global budget is exceeded. vram_scalable
+	// records whether vram_total counts towards the scalable totals.
+	uint64_t vram_bytes[VRAM_KIND_COUNT];
+	uint64_t vram_total;
+	bool vram_scalable;
+	float vram_measure_time;
+	int vram_budget_mb;
+	int vram_scale_shift;
+
+	// Reduced resolution copy of the input, used when a mask needs
+	// the full resolution input_texrender.
+	gs_texrender_t *processing_input_texrender;
+
+	// Early rejection stencil, marking the processing pixels whose
+	// blur can reach the masked output. Built from the mask coverage
+	// and bound to same sized blur passes by stencil_pass_begin. It is
+	// kept until the settings, size, blur reach or baked mask channel
+	// change, except for source masks that are not static.
+	gs_zstencil_t *stencil_zs;
+	gs_texrender_t *stencil_target;
+	gs_texrender_t *stencil_coverage;
+	gs_texrender_t *stencil_zero;
+	gs_texrender_t *stencil_one;
+	uint32_t stencil_width;
+	uint32_t stencil_height;
+	bool stencil_active;
+	bool stencil_valid;
+	float stencil_reach;
+	uint64_t stencil_mask_version;
+
+	// Renderers for vector blur. The gradient is a transient target
+	// of graph.
 	gs_texrender_t* vb_smoothed_gradient;
+	// Persistent render of vector_blur_source.
+	gs_texrender_t *vb_source_render;
+
+	// Down sample chains shared by the kawase based smoothing passes.
+	blur_pyramid_t pyramids[PYRAMID_CACHE_SIZE];
 
 	obs_hotkey_pair_id hotkey;
 
@@ -176,22 +308,35 @@ struct composite_blur_filter_data {
 	// Gaussian Blur
 	gs_eparam_t *param_kernel_size;
 	size_t kernel_size;
-	gs_eparam_t *param_offset;
+	effect_param_t param_offset;
 	fDarray offset;
-	gs_eparam_t *param_weight;
+	effect_param_t param_weight;
 	fDarray kernel;
+	// Bumped by sample_kernel, so the arrays are only uploaded after
+	// they change.
+	uint64_t kernel_version;
 	gs_eparam_t *param_kernel_texture;
 	gs_texture_t *kernel_texture;
 	gs_eparam_t *param_gradient_image;
 	gs_eparam_t *param_gradient_channel;
 	gs_eparam_t *param_gradient_uv_size;
 	gs_eparam_t *param_gradient_map;
+	gs_eparam_t *param_gradient_scale;
+	int vector_gradient_scale;
 	int vector_blur_channel;
 	float vector_blur_amount;
 	float vector_blur_smoothing;
 	int vector_blur_type;
 	float last_vector_blur_amount;
 	obs_weak_source_t* vector_blur_source;
+	// When the vector source is static, the gradient and smoothed
+	// gradient are only rebuilt when vb_gradient_dirty is set.
+	bool vector_source_static;
+	bool vb_gradient_dirty;
+	uint32_t vb_source_width;
+	uint32_t vb_source_height;
+	uint32_t vb_gradient_width;
+	uint32_t vb_gradient_height;
 	gs_eparam_t* param_inactive_radius;
 
 	// Box Blur
@@ -204,6 +349,7 @@ struct composite_blur_filter_data {
 	int pixelate_type;
 	int pixelate_type_last;
 	struct vec2 pixelate_tessel_center;
+	bool pixelate_origin_set;
 	float pixelate_tessel_rot;
 	float pixelate_smoothing_pct;
 	float pixelate_cos_theta;
@@ -221,7 +367,57 @@ struct composite_blur_filter_data {
 	gs_eparam_t *param_pixel_cos_rtheta;
 	gs_eparam_t *param_pixel_sin_rtheta;
 	gs_eparam_t* param_pixel_time;
-	gs_texrender_t *pixelate_texrender;
+	gs_eparam_t *param_pixel_image_lod;
+	gs_eparam_t *param_pixel_lod_mix;
+	// One texel per square pixelate cell, holding the cell average.
+	gs_texrender_t *pixelate_cells_texrender;
+	bool pixelate_cell_average;
+	// pixelate_cells_effect parameters.
+	effect_param_t param_cells_image;
+	effect_param_t param_cells_cells;
+	effect_param_t param_cells_uv_size;
+	effect_param_t param_cells_pixel_size;
+	effect_param_t param_cells_tess_origin;
+	effect_param_t param_cells_cos_theta;
+	effect_param_t param_cells_sin_theta;
+	effect_param_t param_cells_cos_rtheta;
+	effect_param_t param_cells_sin_rtheta;
+	effect_param_t param_cells_cell_min;
+	effect_param_t param_cells_cell_count;
+	// Voronoi nearest seed map (jump flood ping-pong pair), and the
+	// settings it was last built for.
+	gs_texrender_t *voronoi_seed_map;
+	gs_texrender_t *voronoi_seed_map2;
+	bool voronoi_seed_map_valid;
+	uint32_t voronoi_map_width;
+	uint32_t voronoi_map_height;
+	float voronoi_map_pixel_size;
+	float voronoi_map_time;
+	struct vec2 voronoi_map_origin;
+	float voronoi_map_cos_theta;
+	float voronoi_map_sin_theta;
+	gs_eparam_t *param_pixel_seed_map;
+	// voronoi_jfa_effect parameters.
+	effect_param_t param_jfa_image;
+	effect_param_t param_jfa_jump;
+	effect_param_t param_jfa_uv_size;
+	effect_param_t param_jfa_pixel_size;
+	effect_param_t param_jfa_tess_origin;
+	effect_param_t param_jfa_cos_theta;
+	effect_param_t param_jfa_sin_theta;
+	effect_param_t param_jfa_time;
+	// Baked cell centers for the tessellation pixelate types, and the
+	// settings they were last baked for.
+	gs_texrender_t *pixelate_cell_map;
+	bool pixelate_cell_map_valid;
+	int pixelate_cell_map_type;
+	uint32_t pixelate_cell_map_width;
+	uint32_t pixelate_cell_map_height;
+	float pixelate_cell_map_pixel_size;
+	struct vec2 pixelate_cell_map_origin;
+	float pixelate_cell_map_cos_theta;
+	float pixelate_cell_map_sin_theta;
+	gs_eparam_t *param_pixel_cell_map;
 
 	// Radial Blur
 	gs_eparam_t *param_radial_center;
@@ -230,6 +426,9 @@ struct composite_blur_filter_data {
 
 	// Motion/Directional Blur
 	float angle;
+	bool log_step;
+	int log_step_passes;
+	gs_eparam_t *param_log_step_texel_step;
 
 	// Tilt-Shift
 	gs_eparam_t *param_focus_width;
@@ -245,15 +444,43 @@ struct composite_blur_filter_data {
 	// gs_texture_t* prior_image_texture;
 	gs_eparam_t* param_temporal_current_weight;
 	gs_eparam_t* param_temporal_clear_threshold;
+	gs_eparam_t *param_temporal_sum_image;
+	gs_eparam_t *param_temporal_oldest_image;
+	gs_eparam_t *param_temporal_sum_weight;
+	gs_eparam_t *param_temporal_oldest_weight;
+	gs_eparam_t *param_temporal_frame_count;
+	gs_eparam_t *param_temporal_store_offset;
 	float temporal_current_weight;
 	float temporal_clear_threshold;
 	bool temporal_prior_stored;
+	int temporal_mode;
+	int temporal_frames;
+	int temporal_history_scale;
+	// History targets owned by the temporal blur, at 1/scale of the
+	// frame size. Exponential mode keeps the prior output in
+	// temporal_history, box mode a ring of the last temporal_frames
+	// frames plus their running sum (GS_RGBA32F ping-pong pair).
+	// temporal_newest takes the incoming frame before it enters the
+	// ring.
+	gs_texrender_t *temporal_history;
+	gs_texrender_t *temporal_ring[TEMPORAL_MAX_FRAMES];
+	gs_texrender_t *temporal_newest;
+	gs_texrender_t *temporal_sum;
+	gs_texrender_t *temporal_sum2;
+	int temporal_ring_head;
+	int temporal_ring_count;
+	uint32_t temporal_history_width;
+	uint32_t temporal_history_height;
 
 	// Compositing
 	gs_eparam_t *param_background;
 	obs_weak_source_t *background;
 	struct dstr background_source_name;
 	bool has_background_source;
+	// Set from the global source signals, on whichever thread created,
+	// renamed or destroyed a source. The video tick then re-resolves
+	// the mask and background references on the graphics thread.
+	volatile bool sources_dirty;
 
 	// Mask
 	int mask_type;
@@ -286,6 +513,17 @@ struct composite_blur_filter_data {
 	gs_eparam_t *param_mask_source_invert;
 	bool mask_source_invert;
 	obs_weak_source_t *mask_source_source;
+	// Source and image masks are baked into a single channel texture
+	// at 1/mask_source_scale of the mask size. Static source masks and
+	// image masks are only re-baked when mask_channel_dirty is set.
+	gs_texrender_t *mask_source_render;
+	gs_texrender_t *mask_channel_render;
+	int mask_source_scale;
+	bool mask_source_static;
+	bool mask_channel_dirty;
+	uint64_t mask_channel_frame_time;
+	// Bumped every time the channel is baked.
+	uint64_t mask_channel_version;
 	gs_eparam_t *param_mask_circle_center;
 	float mask_circle_center_x;
 	float mask_circle_center_y;
@@ -303,13 +541,52 @@ struct composite_blur_filter_data {
 	float mask_rect_corner_radius;
 	float mask_rect_feathering;
 	float mask_rect_inv;
-	gs_image_file_t *mask_image;
+	effect_mask_region_t mask_regions[EFFECT_MASK_MAX_REGIONS];
+	int mask_region_count;
+	bool mask_regions_inv;
+	// Entries of the regions list that failed to parse, one per line,
+	// so each new set is logged once.
+	struct dstr mask_regions_invalid;
+	gs_eparam_t *param_mask_regions_uv_scale;
+	gs_eparam_t *param_mask_regions_shape;
+	gs_eparam_t *param_mask_regions_params;
+	gs_eparam_t *param_mask_regions_count;
+	gs_eparam_t *param_mask_regions_inv;
+	// Shared, asynchronously decoded image mask. Acquired on the
+	// graphics thread once the filter size is known, and re-acquired
+	// when either the path or the size changes.
+	struct dstr mask_image_path;
+	image_mask_t *mask_image;
+	gs_texture_t *mask_image_texture;
 
 	// Output Effect Parameters
 	gs_eparam_t *param_output_image;
-
+	gs_eparam_t *param_output_linear;
+	// Whether the intermediates hold linear GS_RGBA16F values (HDR
+	// sources) rather than sRGB encoded GS_RGBA.
+	bool pipeline_linear;
+
+	// Reduced Resolution Processing
+	int processing_scale_setting;
+	int processing_scale;
+	gs_eparam_t *param_resample_source_size;
+	gs_eparam_t *param_resample_scale;
+
+	// Size of the blur passes. Equal to full_width/full_height unless
+	// a reduced processing scale is active during video_render.
 	uint32_t width;
 	uint32_t height;
+	uint32_t full_width;
+	uint32_t full_height;
+
+	// Region of interest, in full resolution pixels. When active the
+	// blur passes only cover this rectangle of the input, and the
+	// result is composited back over an unblurred copy.
+	bool roi_active;
+	uint32_t roi_x;
+	uint32_t roi_y;
+	uint32_t roi_width;
+	uint32_t roi_height;
 
 	uint32_t device_type;
 
@@ -326,6 +603,14 @@ static void composite_blur_destroy(void *data);
 static uint32_t composite_blur_width(void *data);
 static uint32_t composite_blur_height(void *data);
 static void composite_blur_rename(void *data, calldata_t *call_data);
+static void composite_blur_sources_changed(void *data, calldata_t *call_data);
+static void sync_named_source(composite_blur_filter_data_t *filter,
+			      obs_weak_source_t **weak, bool has_source,
+			      struct dstr *name, const char *setting);
+static void release_unused_resources(composite_blur_filter_data_t *filter);
+static void release_render_targets(composite_blur_filter_data_t *filter);
+static void vram_measure(composite_blur_filter_data_t *filter);
+static void vram_enforce_budget(composite_blur_filter_data_t *filter);
 static void composite_blur_update(void *data, obs_data_t *settings);
 static void composite_blur_video_render(void *data, gs_effect_t *effect);
 static void composite_blur_video_tick(void *data, float seconds);
@@ -334,6 +619,44 @@ static void composite_blur_reload_effect(composite_blur_filter_data_t *filter);
 static void load_composite_effect(composite_blur_filter_data_t *filter);
 static void load_mix_effect(composite_blur_filter_data_t *filter);
 static void load_output_effect(composite_blur_filter_data_t *filter);
+static void load_resample_effect(composite_blur_filter_data_t *filter);
+static void load_stencil_effect(composite_blur_filter_data_t *filter);
+static void stencil_update(composite_blur_filter_data_t *filter);
+extern void stencil_pass_begin(composite_blur_filter_data_t *data);
+extern void stencil_pass_end(composite_blur_filter_data_t *data);
+static bool processing_scale_supported(composite_blur_filter_data_t *filter);
+static int get_processing_scale(composite_blur_filter_data_t *filter);
+static void update_processing_scale(composite_blur_filter_data_t *filter,
+				    obs_data_t *settings);
+static void processing_scale_begin(composite_blur_filter_data_t *filter,
+				   int scale);
+static void processing_scale_end(composite_blur_filter_data_t *filter,
+				 int scale);
+static void apply_effect_mask_regions(composite_blur_filter_data_t *filter);
+static gs_texture_t *
+mask_source_channel(composite_blur_filter_data_t *filter);
+static gs_texture_t *
+mask_image_texture(composite_blur_filter_data_t *filter);
+static void load_regions_mask_effect(composite_blur_filter_data_t *filter);
+static bool parse_mask_region(const char *text,
+			      effect_mask_region_t *region);
+static int parse_mask_regions(obs_data_t *settings,
+			      effect_mask_region_t *regions,
+			      struct dstr *invalid);
+static bool setting_mask_regions_modified(obs_properties_t *props,
+					  obs_property_t *p,
+					  obs_data_t *settings);
+static void resample_texture(composite_blur_filter_data_t *filter,
+			     gs_texture_t *texture, gs_texrender_t *dest,
+			     uint32_t width, uint32_t height,
+			     const char *technique);
+static void resample_draw(composite_blur_filter_data_t *filter,
+			  gs_texture_t *texture, uint32_t source_x,
+			  uint32_t source_y, uint32_t source_cx,
+			  uint32_t source_cy, uint32_t width, uint32_t height,
+			  const char *technique);
+static float get_blur_extent(composite_blur_filter_data_t *filter);
+static void roi_update(composite_blur_filter_data_t *filter);
 extern gs_texture_t *blend_composite(gs_texture_t *texture,
 				     composite_blur_filter_data_t *data);
 
@@ -346,6 +669,9 @@ static bool setting_effect_mask_modified(obs_properties_t *props,
 static bool setting_blur_types_modified(void *data, obs_properties_t *props,
 					obs_property_t *p,
 					obs_data_t *settings);
+static bool setting_temporal_mode_modified(obs_properties_t *props,
+					   obs_property_t *p,
+					   obs_data_t *settings);
 static bool setting_pixelate_animate_modified(obs_properties_t* props,
 					obs_property_t* p,
 					obs_data_t* settings);
@@ -355,10 +681,13 @@ static void set_blur_radius_settings(const char *name, float min_val,
 				     float max_val, float step_size,
 				     obs_properties_t *props);
 static bool settings_blur_area(obs_properties_t *props, obs_data_t *settings);
-static bool settings_blur_directional(obs_properties_t *props);
+static bool settings_blur_directional(obs_properties_t *props,
+				      obs_data_t *settings);
 static bool settings_blur_zoom(obs_properties_t *props);
 static bool settings_blur_tilt_shift(obs_properties_t *props);
 static bool settings_blur_vector(obs_properties_t* props, composite_blur_filter_data_t* filter);
+static void setting_processing_scale_visibility(obs_properties_t *props,
+						obs_data_t *settings);
 
 static void apply_effect_mask(composite_blur_filter_data_t *filter);
 static void apply_effect_mask_crop(composite_blur_filter_data_t *filter);
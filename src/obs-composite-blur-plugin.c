@@ -1,8 +1,10 @@
 #include <obs-module.h>
 
 #include "version.h"
+#include "image-mask-cache.h"
 
 extern struct obs_source_info obs_composite_blur;
+extern struct obs_source_info obs_composite_blur_cpu;
 
 OBS_DECLARE_MODULE();
 
@@ -14,11 +16,15 @@ bool obs_module_load(void)
 {
 	blog(LOG_INFO, "[Composite Blur] loaded version %s", PROJECT_VERSION);
 	obs_register_source(&obs_composite_blur);
+	obs_register_source(&obs_composite_blur_cpu);
 
 	return true;
 }
 
-void obs_module_unload(void) {}
+void obs_module_unload(void)
+{
+	image_mask_cache_shutdown();
+}
 
 float (*move_get_transition_filter)(obs_source_t *filter_from,
 				    obs_source_t **filter_to) = NULL;
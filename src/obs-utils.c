@@ -1,9 +1,48 @@
 #include "obs-utils.h"
 
+// Format of the RGBA intermediates of the filter currently rendering.
+// Graphics thread only, see set_pipeline_format.
+static enum gs_color_format pipeline_format = GS_RGBA;
+
 gs_texrender_t *create_or_reset_texrender(gs_texrender_t *render)
 {
+	return create_or_reset_texrender_format(render, pipeline_format);
+}
+
+// Sets the format create_or_reset_texrender allocates, returning the
+// previous one so nested filter renders can restore it.
+enum gs_color_format set_pipeline_format(enum gs_color_format format)
+{
+	const enum gs_color_format prior = pipeline_format;
+	pipeline_format = format;
+	return prior;
+}
+
+enum gs_color_format get_pipeline_format(void)
+{
+	return pipeline_format;
+}
+
+// Enables the ordered dither of dither.effect for 8 bit targets.
+void set_dither_strength(effect_param_t *param, enum gs_color_format format)
+{
+	const bool unorm8 = format == GS_RGBA || format == GS_BGRA ||
+			    format == GS_BGRX || format == GS_R8 ||
+			    format == GS_R8G8;
+	effect_param_set_float(param, unorm8 ? 1.0f : 0.0f);
+}
+
+// Texrenders are swapped between pipeline stages, so one created for a
+// different format may land here. Recreate it when the format differs.
+gs_texrender_t *create_or_reset_texrender_format(gs_texrender_t *render,
+						 enum gs_color_format format)
+{
+	if (render && gs_texrender_get_format(render) != format) {
+		gs_texrender_destroy(render);
+		render = NULL;
+	}
 	if (!render) {
-		render = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+		render = gs_texrender_create(format, GS_ZS_NONE);
 	} else {
 		gs_texrender_reset(render);
 	}
@@ -150,3 +189,21 @@ char *load_shader_from_file(const char *file_name)
 
 	return shader_file.array;
 }
+
+// Approximate GPU memory held by a texture, ignoring driver padding.
+uint64_t texture_vram_bytes(gs_texture_t *texture)
+{
+	if (!texture) {
+		return 0;
+	}
+	const uint64_t bpp =
+		gs_get_format_bpp(gs_texture_get_color_format(texture));
+	return (uint64_t)gs_texture_get_width(texture) *
+	       gs_texture_get_height(texture) * bpp / 8;
+}
+
+uint64_t texrender_vram_bytes(gs_texrender_t *render)
+{
+	return render ? texture_vram_bytes(gs_texrender_get_texture(render))
+		      : 0;
+}
@@ -8,11 +8,22 @@
 
 #include <stdio.h>
 
+#include "effect-param.h"
+
 extern gs_texrender_t *create_or_reset_texrender(gs_texrender_t *render);
+extern enum gs_color_format set_pipeline_format(enum gs_color_format format);
+extern enum gs_color_format get_pipeline_format(void);
+extern void set_dither_strength(effect_param_t *param,
+				enum gs_color_format format);
+extern gs_texrender_t *
+create_or_reset_texrender_format(gs_texrender_t *render,
+				 enum gs_color_format format);
 extern void set_blending_parameters();
 extern void set_render_parameters();
 void texrender_set_texture(gs_texture_t *source, gs_texrender_t *dest);
 extern bool add_source_to_list(void *data, obs_source_t *source);
 gs_effect_t *load_shader_effect(gs_effect_t *effect,
 				const char *effect_file_path);
-extern char *load_shader_from_file(const char *file_name);
\ No newline at end of file
+extern char *load_shader_from_file(const char *file_name);
+extern uint64_t texture_vram_bytes(gs_texture_t *texture);
+extern uint64_t texrender_vram_bytes(gs_texrender_t *render);
@@ -0,0 +1,276 @@
+#include "render-graph.h"
+
+/*
+ *  Hands out an idle pooled target, preferring one of the same size so
+ *  gs_texrender_begin does not have to reallocate it. Returns -1 when
+ *  every entry is in use.
+ */
+static int render_pool_acquire(render_pool_t *pool, uint32_t width,
+			       uint32_t height, enum gs_color_format format)
+{
+	int index = -1;
+	for (int i = 0; i < RENDER_POOL_SIZE; i++) {
+		render_pool_entry_t *entry = &pool->entries[i];
+		if (entry->busy) {
+			continue;
+		}
+		if (entry->texrender && entry->width == width &&
+		    entry->height == height && entry->format == format) {
+			index = i;
+			break;
+		}
+		// Otherwise take an empty entry, or the least recently used.
+		if (index < 0 || (pool->entries[index].texrender &&
+				  (!entry->texrender ||
+				   entry->generation <
+					   pool->entries[index].generation))) {
+			index = i;
+		}
+	}
+	if (index < 0) {
+		return -1;
+	}
+
+	render_pool_entry_t *entry = &pool->entries[index];
+	entry->texrender =
+		create_or_reset_texrender_format(entry->texrender, format);
+	entry->width = width;
+	entry->height = height;
+	entry->format = format;
+	entry->busy = true;
+	entry->generation = pool->generation;
+	return index;
+}
+
+// Frees targets no pass asked for during the current generation.
+static void render_pool_trim(render_pool_t *pool)
+{
+	for (int i = 0; i < RENDER_POOL_SIZE; i++) {
+		render_pool_entry_t *entry = &pool->entries[i];
+		if (entry->texrender && !entry->busy &&
+		    entry->generation < pool->generation) {
+			gs_texrender_destroy(entry->texrender);
+			entry->texrender = NULL;
+		}
+	}
+}
+
+void render_pool_free(render_pool_t *pool)
+{
+	for (int i = 0; i < RENDER_POOL_SIZE; i++) {
+		if (pool->entries[i].texrender) {
+			gs_texrender_destroy(pool->entries[i].texrender);
+		}
+	}
+	memset(pool->entries, 0, sizeof(pool->entries));
+}
+
+uint64_t render_pool_vram_bytes(render_pool_t *pool)
+{
+	uint64_t bytes = 0;
+	for (int i = 0; i < RENDER_POOL_SIZE; i++) {
+		bytes += texrender_vram_bytes(pool->entries[i].texrender);
+	}
+	return bytes;
+}
+
+/*
+ *  Starts declaring a new frame. Targets held by the previous frame's
+ *  sinks go back to the pool, so a pool should back a single graph.
+ */
+void render_graph_begin(render_graph_t *graph, render_pool_t *pool)
+{
+	graph->pool = pool;
+	graph->resource_count = 0;
+	graph->pass_count = 0;
+	pool->generation++;
+	for (int i = 0; i < RENDER_POOL_SIZE; i++) {
+		pool->entries[i].busy = false;
+	}
+}
+
+static int render_graph_add_resource(render_graph_t *graph)
+{
+	if (graph->resource_count >= RENDER_GRAPH_MAX_RESOURCES) {
+		blog(LOG_WARNING, "[Composite Blur] Render graph is full");
+		return -1;
+	}
+	render_graph_resource_t *resource =
+		&graph->resources[graph->resource_count];
+	memset(resource, 0, sizeof(render_graph_resource_t));
+	resource->pool_index = -1;
+	resource->last_use = -1;
+	return graph->resource_count++;
+}
+
+// Declares a transient target, allocated from the pool when a live
+// pass first writes it and returned after its last reader.
+int render_graph_create(render_graph_t *graph, uint32_t width,
+			uint32_t height, enum gs_color_format format)
+{
+	const int index = render_graph_add_resource(graph);
+	if (index >= 0) {
+		render_graph_resource_t *resource = &graph->resources[index];
+		resource->width = width;
+		resource->height = height;
+		resource->format = format;
+	}
+	return index;
+}
+
+int render_graph_import(render_graph_t *graph, gs_texrender_t *texrender,
+			bool valid)
+{
+	const int index = render_graph_add_resource(graph);
+	if (index >= 0) {
+		render_graph_resource_t *resource = &graph->resources[index];
+		resource->texrender = texrender;
+		resource->imported = true;
+		resource->valid = valid && texrender;
+	}
+	return index;
+}
+
+void render_graph_add_pass(render_graph_t *graph, const char *name,
+			   const int *inputs, int input_count, int output,
+			   render_graph_pass_fn execute, void *param)
+{
+	if (graph->pass_count >= RENDER_GRAPH_MAX_PASSES ||
+	    input_count > RENDER_GRAPH_MAX_INPUTS || output < 0) {
+		blog(LOG_WARNING,
+		     "[Composite Blur] Render graph pass '%s' dropped", name);
+		return;
+	}
+	render_graph_pass_t *pass = &graph->passes[graph->pass_count++];
+	pass->name = name;
+	pass->execute = execute;
+	pass->param = param;
+	pass->input_count = input_count;
+	for (int i = 0; i < input_count; i++) {
+		pass->inputs[i] = inputs[i];
+	}
+	pass->output = output;
+	pass->live = false;
+}
+
+// Marks a resource as read after the graph, keeping it and the passes
+// producing it alive.
+void render_graph_mark_sink(render_graph_t *graph, int resource)
+{
+	if (resource >= 0 && resource < graph->resource_count) {
+		graph->resources[resource].sink = true;
+	}
+}
+
+static void render_graph_cull(render_graph_t *graph)
+{
+	bool needed[RENDER_GRAPH_MAX_RESOURCES];
+	for (int i = 0; i < graph->resource_count; i++) {
+		needed[i] = graph->resources[i].sink;
+	}
+
+	// Walk back from the sinks. A pass survives when something reads
+	// its output and that output doesn't already hold valid content.
+	for (int i = graph->pass_count - 1; i >= 0; i--) {
+		render_graph_pass_t *pass = &graph->passes[i];
+		const render_graph_resource_t *output =
+			&graph->resources[pass->output];
+		pass->live = needed[pass->output] && !output->valid;
+		if (!pass->live) {
+			continue;
+		}
+		for (int j = 0; j < pass->input_count; j++) {
+			if (pass->inputs[j] >= 0) {
+				needed[pass->inputs[j]] = true;
+			}
+		}
+	}
+
+	for (int i = 0; i < graph->pass_count; i++) {
+		const render_graph_pass_t *pass = &graph->passes[i];
+		if (!pass->live) {
+			continue;
+		}
+		for (int j = 0; j < pass->input_count; j++) {
+			if (pass->inputs[j] >= 0) {
+				graph->resources[pass->inputs[j]].last_use = i;
+			}
+		}
+	}
+}
+
+static void render_graph_release(render_graph_t *graph, int index)
+{
+	render_graph_resource_t *resource = &graph->resources[index];
+	if (resource->pool_index >= 0 && !resource->sink) {
+		graph->pool->entries[resource->pool_index].busy = false;
+		resource->pool_index = -1;
+	}
+}
+
+/*
+ *  Culls passes whose outputs are never read, then runs the rest in
+ *  declaration order. Transient targets are returned to the pool after
+ *  their last reader, so later passes with the same size and format
+ *  alias them.
+ */
+void render_graph_execute(render_graph_t *graph)
+{
+	render_graph_cull(graph);
+
+	for (int i = 0; i < graph->pass_count; i++) {
+		render_graph_pass_t *pass = &graph->passes[i];
+		if (!pass->live) {
+			continue;
+		}
+
+		gs_texrender_t *inputs[RENDER_GRAPH_MAX_INPUTS] = {NULL};
+		bool ready = true;
+		for (int j = 0; j < pass->input_count; j++) {
+			inputs[j] = pass->inputs[j] >= 0
+					    ? graph->resources[pass->inputs[j]]
+						      .texrender
+					    : NULL;
+			ready = ready && inputs[j];
+		}
+
+		render_graph_resource_t *output =
+			&graph->resources[pass->output];
+		if (ready && !output->imported && output->pool_index < 0) {
+			output->pool_index = render_pool_acquire(
+				graph->pool, output->width, output->height,
+				output->format);
+			output->texrender =
+				output->pool_index >= 0
+					? graph->pool
+						  ->entries[output->pool_index]
+						  .texrender
+					: NULL;
+		}
+
+		if (ready && output->texrender) {
+			// Pooled targets are reset when acquired.
+			if (output->imported) {
+				gs_texrender_reset(output->texrender);
+			}
+			pass->execute(pass->param, inputs, output->texrender);
+		}
+
+		for (int j = 0; j < pass->input_count; j++) {
+			if (pass->inputs[j] >= 0 &&
+			    graph->resources[pass->inputs[j]].last_use == i) {
+				render_graph_release(graph, pass->inputs[j]);
+			}
+		}
+	}
+
+	render_pool_trim(graph->pool);
+}
+
+gs_texrender_t *render_graph_get(render_graph_t *graph, int resource)
+{
+	if (resource < 0 || resource >= graph->resource_count) {
+		return NULL;
+	}
+	return graph->resources[resource].texrender;
+}
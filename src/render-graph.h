@@ -0,0 +1,83 @@
+#pragma once
+
+#include <obs-module.h>
+#include "obs-utils.h"
+
+#define RENDER_POOL_SIZE 8
+#define RENDER_GRAPH_MAX_PASSES 16
+#define RENDER_GRAPH_MAX_RESOURCES 16
+#define RENDER_GRAPH_MAX_INPUTS 4
+
+// Transient render targets keyed by size and format. Targets released
+// within a frame are handed to the next stage asking for the same size
+// and format, and targets no stage asked for during a frame are freed.
+typedef struct render_pool_entry {
+	gs_texrender_t *texrender;
+	uint32_t width;
+	uint32_t height;
+	enum gs_color_format format;
+	bool busy;
+	uint64_t generation;
+} render_pool_entry_t;
+
+typedef struct render_pool {
+	render_pool_entry_t entries[RENDER_POOL_SIZE];
+	uint64_t generation;
+} render_pool_t;
+
+// Executes a pass. inputs holds the targets of the declared inputs,
+// and output a target reset for the pass to render into.
+typedef void (*render_graph_pass_fn)(void *param,
+				     gs_texrender_t *const *inputs,
+				     gs_texrender_t *output);
+
+typedef struct render_graph_resource {
+	uint32_t width;
+	uint32_t height;
+	enum gs_color_format format;
+	// Imported targets are owned by the caller and never pooled.
+	// Valid imported targets already hold their content, so the
+	// passes writing them are culled.
+	gs_texrender_t *texrender;
+	bool imported;
+	bool valid;
+	bool sink;
+	int pool_index;
+	int last_use;
+} render_graph_resource_t;
+
+typedef struct render_graph_pass {
+	const char *name;
+	render_graph_pass_fn execute;
+	void *param;
+	int inputs[RENDER_GRAPH_MAX_INPUTS];
+	int input_count;
+	int output;
+	bool live;
+} render_graph_pass_t;
+
+// A frame's worth of passes, declared up front with their inputs and
+// outputs, then culled, allocated and executed in declaration order.
+typedef struct render_graph {
+	render_pool_t *pool;
+	render_graph_resource_t resources[RENDER_GRAPH_MAX_RESOURCES];
+	int resource_count;
+	render_graph_pass_t passes[RENDER_GRAPH_MAX_PASSES];
+	int pass_count;
+} render_graph_t;
+
+extern void render_pool_free(render_pool_t *pool);
+extern uint64_t render_pool_vram_bytes(render_pool_t *pool);
+
+extern void render_graph_begin(render_graph_t *graph, render_pool_t *pool);
+extern int render_graph_create(render_graph_t *graph, uint32_t width,
+			       uint32_t height, enum gs_color_format format);
+extern int render_graph_import(render_graph_t *graph,
+			       gs_texrender_t *texrender, bool valid);
+extern void render_graph_add_pass(render_graph_t *graph, const char *name,
+				  const int *inputs, int input_count,
+				  int output, render_graph_pass_fn execute,
+				  void *param);
+extern void render_graph_mark_sink(render_graph_t *graph, int resource);
+extern void render_graph_execute(render_graph_t *graph);
+extern gs_texrender_t *render_graph_get(render_graph_t *graph, int resource);
@@ -0,0 +1,122 @@
+#include "thread-pool.h"
+
+// Hands out chunks until the job is exhausted.
+static void thread_pool_work(thread_pool_t *pool)
+{
+	for (;;) {
+		const uint64_t index =
+			(uint64_t)(os_atomic_inc_long(&pool->next_chunk) - 1);
+		const uint64_t start = index * pool->chunk;
+		if (start >= pool->count) {
+			break;
+		}
+		uint64_t end = start + pool->chunk;
+		end = end < pool->count ? end : pool->count;
+		pool->task(pool->param, (uint32_t)start, (uint32_t)end);
+	}
+}
+
+static void *thread_pool_thread(void *param)
+{
+	thread_pool_t *pool = param;
+	os_set_thread_name("composite-blur: cpu worker");
+
+	for (;;) {
+		os_sem_wait(pool->start_sem);
+		if (os_atomic_load_bool(&pool->stop)) {
+			break;
+		}
+		thread_pool_work(pool);
+		os_sem_post(pool->done_sem);
+	}
+	return NULL;
+}
+
+/*
+ *  Starts thread_count workers. The thread calling thread_pool_run
+ *  works on the job as well, so a pool of 0 threads runs jobs inline.
+ */
+thread_pool_t *thread_pool_create(int thread_count)
+{
+	thread_pool_t *pool = bzalloc(sizeof(thread_pool_t));
+	pthread_mutex_init(&pool->run_mutex, NULL);
+	if (os_sem_init(&pool->start_sem, 0) != 0 ||
+	    os_sem_init(&pool->done_sem, 0) != 0) {
+		thread_pool_destroy(pool);
+		return NULL;
+	}
+
+	thread_count = thread_count > 0 ? thread_count : 0;
+	pool->threads = bzalloc(sizeof(pthread_t) * (thread_count + 1));
+	for (int i = 0; i < thread_count; i++) {
+		if (pthread_create(&pool->threads[pool->thread_count], NULL,
+				   thread_pool_thread, pool) != 0) {
+			blog(LOG_WARNING,
+			     "[Composite Blur] Started %d of %d CPU workers",
+			     pool->thread_count, thread_count);
+			break;
+		}
+		pool->thread_count++;
+	}
+	return pool;
+}
+
+void thread_pool_destroy(thread_pool_t *pool)
+{
+	if (!pool) {
+		return;
+	}
+	os_atomic_store_bool(&pool->stop, true);
+	for (int i = 0; i < pool->thread_count; i++) {
+		os_sem_post(pool->start_sem);
+	}
+	for (int i = 0; i < pool->thread_count; i++) {
+		pthread_join(pool->threads[i], NULL);
+	}
+	if (pool->start_sem) {
+		os_sem_destroy(pool->start_sem);
+	}
+	if (pool->done_sem) {
+		os_sem_destroy(pool->done_sem);
+	}
+	pthread_mutex_destroy(&pool->run_mutex);
+	bfree(pool->threads);
+	bfree(pool);
+}
+
+/*
+ *  Runs task over [0, count) and returns once every item is done.
+ *  Items are handed out in chunks of at least min_chunk, with about
+ *  four chunks per thread so uneven rows still balance.
+ */
+void thread_pool_run(thread_pool_t *pool, uint32_t count, uint32_t min_chunk,
+		     thread_pool_task_fn task, void *param)
+{
+	if (count == 0) {
+		return;
+	}
+	if (!pool || pool->thread_count == 0) {
+		task(param, 0, count);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->run_mutex);
+	const uint32_t chunks = (uint32_t)(pool->thread_count + 1) * 4;
+	uint32_t chunk = (count + chunks - 1) / chunks;
+	pool->chunk = chunk > min_chunk ? chunk : (min_chunk ? min_chunk : 1);
+	pool->task = task;
+	pool->param = param;
+	pool->count = count;
+	os_atomic_store_long(&pool->next_chunk, 0);
+
+	// Every start is answered by exactly one done, whichever worker
+	// takes it, so waiting for thread_count dones drains the job.
+	for (int i = 0; i < pool->thread_count; i++) {
+		os_sem_post(pool->start_sem);
+	}
+	thread_pool_work(pool);
+	for (int i = 0; i < pool->thread_count; i++) {
+		os_sem_wait(pool->done_sem);
+	}
+	pthread_mutex_unlock(&pool->run_mutex);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <obs-module.h>
+#include <util/threading.h>
+
+// Processes items [start, end) of a job. Called concurrently from the
+// workers and the thread running the job, on disjoint ranges.
+typedef void (*thread_pool_task_fn)(void *param, uint32_t start,
+				    uint32_t end);
+
+// Fixed set of worker threads splitting a range of items (e.g. rows)
+// between them. Jobs from different threads are run one at a time.
+typedef struct thread_pool {
+	pthread_t *threads;
+	int thread_count;
+	os_sem_t *start_sem;
+	os_sem_t *done_sem;
+	pthread_mutex_t run_mutex;
+	volatile bool stop;
+
+	// Current job, only written while no worker is running.
+	thread_pool_task_fn task;
+	void *param;
+	uint32_t count;
+	uint32_t chunk;
+	volatile long next_chunk;
+} thread_pool_t;
+
+extern thread_pool_t *thread_pool_create(int thread_count);
+extern void thread_pool_destroy(thread_pool_t *pool);
+extern void thread_pool_run(thread_pool_t *pool, uint32_t count,
+			    uint32_t min_chunk, thread_pool_task_fn task,
+			    void *param);
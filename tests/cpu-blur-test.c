@@ -0,0 +1,591 @@
+#include "blur/cpu_blur.h"
+#include "test-common.h"
+
+#include <math.h>
+
+// Plane with a few bytes of padding per row, so linesize differs from
+// width * channels like in real frames.
+static cpu_plane_t plane_create(uint32_t width, uint32_t height,
+				uint32_t channels)
+{
+	cpu_plane_t plane = {NULL, width * channels + 13, width, height,
+			     channels};
+	plane.data = calloc(plane.linesize, height);
+	return plane;
+}
+
+static void plane_fill_random(cpu_plane_t *plane, unsigned int seed)
+{
+	srand(seed);
+	for (size_t i = 0; i < (size_t)plane->linesize * plane->height; i++) {
+		plane->data[i] = (uint8_t)(rand() & 255);
+	}
+}
+
+static inline uint8_t *plane_at(const cpu_plane_t *plane, int x, int y)
+{
+	x = x < 0 ? 0 : (x >= (int)plane->width ? (int)plane->width - 1 : x);
+	y = y < 0 ? 0 : (y >= (int)plane->height ? (int)plane->height - 1 : y);
+	return plane->data + (size_t)y * plane->linesize +
+	       (size_t)x * plane->channels;
+}
+
+// Number of bytes that differ between the visible parts of a and b.
+static int plane_diff(const cpu_plane_t *a, const cpu_plane_t *b)
+{
+	int diff = 0;
+	for (uint32_t y = 0; y < a->height; y++) {
+		diff += memcmp(a->data + (size_t)y * a->linesize,
+			       b->data + (size_t)y * b->linesize,
+			       (size_t)a->width * a->channels) != 0;
+	}
+	return diff;
+}
+
+// Largest difference from value over the visible part of plane.
+static int plane_max_error_flat(const cpu_plane_t *plane, int value)
+{
+	int error = 0;
+	for (uint32_t y = 0; y < plane->height; y++) {
+		const uint8_t *row = plane->data + (size_t)y * plane->linesize;
+		for (uint32_t x = 0; x < plane->width * plane->channels; x++) {
+			const int e = abs(row[x] - value);
+			error = e > error ? e : error;
+		}
+	}
+	return error;
+}
+
+/*
+ *  Separable gaussian in double precision with clamped edges, the
+ *  reference the fixed point and recursive versions are held to.
+ */
+static double reference_gaussian(const cpu_plane_t *src, int x, int y,
+				 int c, double sigma_x, double sigma_y)
+{
+	const int rx = (int)ceil(sigma_x * 4.0);
+	const int ry = (int)ceil(sigma_y * 4.0);
+	double sum = 0.0;
+	double total = 0.0;
+	for (int dy = -ry; dy <= ry; dy++) {
+		const double wy = exp(-(dy * dy) / (2.0 * sigma_y * sigma_y));
+		for (int dx = -rx; dx <= rx; dx++) {
+			const double wx =
+				exp(-(dx * dx) / (2.0 * sigma_x * sigma_x));
+			const double w = wx * wy;
+			sum += w * plane_at(src, x + dx, y + dy)[c];
+			total += w;
+		}
+	}
+	return sum / total;
+}
+
+static double max_error_gaussian(const cpu_plane_t *src,
+				 const cpu_plane_t *dst, double sigma_x,
+				 double sigma_y)
+{
+	double error = 0.0;
+	for (int y = 0; y < (int)src->height; y += 3) {
+		for (int x = 0; x < (int)src->width; x += 2) {
+			for (int c = 0; c < (int)src->channels; c++) {
+				const double e = fabs(
+					reference_gaussian(src, x, y, c,
+							   sigma_x, sigma_y) -
+					plane_at(dst, x, y)[c]);
+				error = e > error ? e : error;
+			}
+		}
+	}
+	return error;
+}
+
+// A flat plane stays flat through every blur, edges included.
+static void test_flat(thread_pool_t *pool)
+{
+	for (uint32_t ch = 1; ch <= 4; ch++) {
+		cpu_plane_t src = plane_create(61, 37, ch);
+		cpu_plane_t dst = plane_create(61, 37, ch);
+		uint8_t *temp = malloc((size_t)61 * ch * 37);
+		memset(src.data, 201, (size_t)src.linesize * src.height);
+
+		cpu_blur_gaussian(pool, &src, &dst, temp, 1.7f, 2.4f);
+		CHECK(plane_max_error_flat(&dst, 201) == 0,
+		      "%u channels: flat kernel gaussian changed", ch);
+		cpu_blur_gaussian(pool, &src, &dst, temp, 9.0f, 0.0f);
+		CHECK(plane_max_error_flat(&dst, 201) == 0,
+		      "%u channels: flat recursive gaussian changed", ch);
+		cpu_blur_box(pool, &src, &dst, temp, 5, 3, 3);
+		CHECK(plane_max_error_flat(&dst, 201) == 0,
+		      "%u channels: flat box blur changed", ch);
+
+		free(temp);
+		free(src.data);
+		free(dst.data);
+	}
+}
+
+// Box blur against a brute force window average, rounded after each
+// direction of each pass like the running sums.
+static void test_box_reference(thread_pool_t *pool)
+{
+	const int rx = 3, ry = 2, passes = 2;
+	cpu_plane_t src = plane_create(45, 31, 2);
+	cpu_plane_t dst = plane_create(45, 31, 2);
+	cpu_plane_t ref = plane_create(45, 31, 2);
+	cpu_plane_t tmp = plane_create(45, 31, 2);
+	uint8_t *temp = malloc((size_t)45 * 2 * 31);
+	plane_fill_random(&src, 1);
+	memcpy(ref.data, src.data, (size_t)src.linesize * src.height);
+
+	for (int pass = 0; pass < passes; pass++) {
+		for (int y = 0; y < (int)src.height; y++) {
+			for (int x = 0; x < (int)src.width; x++) {
+				for (int c = 0; c < 2; c++) {
+					int sum = 0;
+					for (int d = -rx; d <= rx; d++) {
+						sum += plane_at(&ref, x + d,
+								y)[c];
+					}
+					plane_at(&tmp, x, y)[c] =
+						(uint8_t)((sum + rx) /
+							  (2 * rx + 1));
+				}
+			}
+		}
+		for (int y = 0; y < (int)src.height; y++) {
+			for (int x = 0; x < (int)src.width; x++) {
+				for (int c = 0; c < 2; c++) {
+					int sum = 0;
+					for (int d = -ry; d <= ry; d++) {
+						sum += plane_at(&tmp, x,
+								y + d)[c];
+					}
+					plane_at(&ref, x, y)[c] =
+						(uint8_t)((sum + ry) /
+							  (2 * ry + 1));
+				}
+			}
+		}
+	}
+
+	cpu_blur_box(pool, &src, &dst, temp, rx, ry, passes);
+	CHECK(plane_diff(&dst, &ref) == 0,
+	      "box blur differs from the window average");
+
+	free(temp);
+	free(src.data);
+	free(dst.data);
+	free(ref.data);
+	free(tmp.data);
+}
+
+/*
+ *  The fixed point kernel stays within 1.5 levels of the reference:
+ *  each direction rounds to 8 bits once and the weights carry 14 bits.
+ *  Widths that are not a multiple of 8 bytes cover the scalar tails of
+ *  the vectorised passes.
+ */
+static void test_gaussian_reference(thread_pool_t *pool)
+{
+	const uint32_t widths[] = {64, 45};
+	const float sigmas[][2] = {{0.8f, 0.8f}, {2.5f, 1.2f}, {1.5f, 0.0f}};
+	for (size_t w = 0; w < 2; w++) {
+		for (uint32_t ch = 1; ch <= 4; ch += 3) {
+			cpu_plane_t src = plane_create(widths[w], 40, ch);
+			cpu_plane_t dst = plane_create(widths[w], 40, ch);
+			uint8_t *temp = malloc((size_t)widths[w] * ch * 40);
+			plane_fill_random(&src, (unsigned int)(w * 4 + ch));
+			for (size_t s = 0; s < 3; s++) {
+				cpu_blur_gaussian(pool, &src, &dst, temp,
+						  sigmas[s][0], sigmas[s][1]);
+				// Directions below 0.1 are copied.
+				const double error = max_error_gaussian(
+					&src, &dst, sigmas[s][0],
+					sigmas[s][1] > 0.0f ? sigmas[s][1]
+							    : 1e-3);
+				CHECK(error <= 1.5,
+				      "width %u, %u channels, sigma %.1f x "
+				      "%.1f: %.2f levels off",
+				      widths[w], ch, sigmas[s][0],
+				      sigmas[s][1], error);
+			}
+			free(temp);
+			free(src.data);
+			free(dst.data);
+		}
+	}
+}
+
+/*
+ *  The recursive gaussian against the sampled kernel over the range of
+ *  sigmas the CPU filter uses it for. The two differ by the shape of
+ *  the Young & van Vliet response, most on detail a few pixels wide:
+ *  they must stay within 6 levels anywhere and 1.5 levels on average,
+ *  edges included.
+ */
+static void test_iir_matches_fir(void)
+{
+	const float sigmas[] = {3.0f, 4.5f, 8.0f, 16.0f, 32.0f, 60.0f, 80.0f};
+	for (uint32_t ch = 1; ch <= 4; ch += 3) {
+		cpu_plane_t src = plane_create(301, 203, ch);
+		cpu_plane_t fir = plane_create(301, 203, ch);
+		cpu_plane_t iir = plane_create(301, 203, ch);
+		uint8_t *temp = malloc((size_t)301 * ch * 203);
+
+		// Smooth structure plus noise, like a camera frame.
+		srand(ch);
+		for (uint32_t y = 0; y < src.height; y++) {
+			uint8_t *row = src.data + (size_t)y * src.linesize;
+			for (uint32_t x = 0; x < src.width * ch; x++) {
+				const double v = 128.0 +
+						 90.0 * sin(x * 0.05) *
+							 cos(y * 0.07) +
+						 (rand() % 61 - 30);
+				row[x] = (uint8_t)(v < 0.0     ? 0.0
+						   : v > 255.0 ? 255.0
+							       : v);
+			}
+		}
+
+		for (size_t s = 0; s < OBS_COUNTOF(sigmas); s++) {
+			cpu_blur_gaussian_fir(NULL, &src, &fir, temp,
+					      sigmas[s], sigmas[s]);
+			cpu_blur_gaussian_iir(NULL, &src, &iir, temp,
+					      sigmas[s], sigmas[s]);
+			int max_error = 0;
+			double total = 0.0;
+			for (uint32_t y = 0; y < src.height; y++) {
+				const uint8_t *a =
+					fir.data + (size_t)y * fir.linesize;
+				const uint8_t *b =
+					iir.data + (size_t)y * iir.linesize;
+				for (uint32_t x = 0; x < src.width * ch; x++) {
+					const int e = abs(a[x] - b[x]);
+					max_error = e > max_error ? e
+								  : max_error;
+					total += e;
+				}
+			}
+			const double mean =
+				total / ((double)src.width * ch * src.height);
+			CHECK(max_error <= 6 && mean <= 1.5,
+			      "%u channels, sigma %.1f: recursive gaussian "
+			      "%d levels off at most, %.2f on average",
+			      ch, sigmas[s], max_error, mean);
+		}
+
+		free(temp);
+		free(src.data);
+		free(fir.data);
+		free(iir.data);
+	}
+}
+
+/*
+ *  Sigmas on both sides of CPU_BLUR_IIR_MIN_SIGMA pick the method per
+ *  direction, so the small one is still blurred. The planes only vary
+ *  along the small direction, which the large one leaves as is, so the
+ *  result must match the reference like the plain kernel does.
+ */
+static void test_gaussian_anisotropic(thread_pool_t *pool)
+{
+	const float sigmas[][2] = {{0.4f, 6.0f}, {6.0f, 0.4f},
+				   {2.0f, 9.0f}, {9.0f, 2.0f},
+				   {0.0f, 6.0f}, {6.0f, 0.0f}};
+	for (uint32_t ch = 1; ch <= 4; ch += 3) {
+		cpu_plane_t src = plane_create(53, 41, ch);
+		cpu_plane_t dst = plane_create(53, 41, ch);
+		uint8_t *temp = malloc((size_t)53 * ch * 41);
+		uint8_t line[64 * 4];
+		for (size_t s = 0; s < OBS_COUNTOF(sigmas); s++) {
+			const bool rows = sigmas[s][0] < sigmas[s][1];
+			srand((unsigned int)(s * 4 + ch));
+			for (size_t i = 0; i < sizeof(line); i++) {
+				line[i] = (uint8_t)(rand() & 255);
+			}
+			for (uint32_t y = 0; y < src.height; y++) {
+				uint8_t *row =
+					src.data + (size_t)y * src.linesize;
+				for (uint32_t x = 0; x < src.width * ch; x++) {
+					row[x] = rows ? line[x]
+						      : line[y * ch + x % ch];
+				}
+			}
+			cpu_blur_gaussian(pool, &src, &dst, temp, sigmas[s][0],
+					  sigmas[s][1]);
+			// Directions below 0.1 are copied.
+			const double error = max_error_gaussian(
+				&src, &dst,
+				sigmas[s][0] > 0.0f ? sigmas[s][0] : 1e-3,
+				sigmas[s][1] > 0.0f ? sigmas[s][1] : 1e-3);
+			CHECK(error <= 1.5,
+			      "%u channels, sigma %.1f x %.1f: %.2f levels off",
+			      ch, sigmas[s][0], sigmas[s][1], error);
+		}
+		free(temp);
+		free(src.data);
+		free(dst.data);
+	}
+}
+
+// Splitting the work between threads gives the same bytes as running
+// it inline.
+static void test_threaded_matches_inline(thread_pool_t *pool)
+{
+	cpu_plane_t src = plane_create(203, 117, 4);
+	cpu_plane_t a = plane_create(203, 117, 4);
+	cpu_plane_t b = plane_create(203, 117, 4);
+	uint8_t *temp = malloc((size_t)203 * 4 * 117);
+	plane_fill_random(&src, 7);
+
+	cpu_blur_gaussian(pool, &src, &a, temp, 2.2f, 1.4f);
+	cpu_blur_gaussian(NULL, &src, &b, temp, 2.2f, 1.4f);
+	CHECK(plane_diff(&a, &b) == 0, "threaded kernel gaussian differs");
+
+	cpu_blur_gaussian(pool, &src, &a, temp, 7.5f, 12.0f);
+	cpu_blur_gaussian(NULL, &src, &b, temp, 7.5f, 12.0f);
+	CHECK(plane_diff(&a, &b) == 0, "threaded recursive gaussian differs");
+
+	cpu_blur_box(pool, &src, &a, temp, 6, 4, 3);
+	cpu_blur_box(NULL, &src, &b, temp, 6, 4, 3);
+	CHECK(plane_diff(&a, &b) == 0, "threaded box blur differs");
+
+	cpu_pixelate(pool, &src, &a, 9, 5);
+	cpu_pixelate(NULL, &src, &b, 9, 5);
+	CHECK(plane_diff(&a, &b) == 0, "threaded pixelate differs");
+
+	free(temp);
+	free(src.data);
+	free(a.data);
+	free(b.data);
+}
+
+// Every cell, including the partial ones on the right and bottom,
+// holds the rounded average of its source pixels.
+static void test_pixelate(thread_pool_t *pool)
+{
+	const uint32_t size = 6;
+	cpu_plane_t src = plane_create(50, 27, 3);
+	cpu_plane_t dst = plane_create(50, 27, 3);
+	plane_fill_random(&src, 3);
+	cpu_pixelate(pool, &src, &dst, size, size);
+
+	int bad = 0;
+	for (uint32_t y0 = 0; y0 < src.height; y0 += size) {
+		for (uint32_t x0 = 0; x0 < src.width; x0 += size) {
+			const uint32_t y1 = y0 + size < src.height ? y0 + size
+								   : src.height;
+			const uint32_t x1 = x0 + size < src.width ? x0 + size
+								  : src.width;
+			const uint32_t count = (y1 - y0) * (x1 - x0);
+			for (uint32_t c = 0; c < 3; c++) {
+				uint32_t sum = 0;
+				for (uint32_t y = y0; y < y1; y++) {
+					for (uint32_t x = x0; x < x1; x++) {
+						sum += plane_at(&src, x, y)[c];
+					}
+				}
+				const int average = (sum + count / 2) / count;
+				for (uint32_t y = y0; y < y1; y++) {
+					for (uint32_t x = x0; x < x1; x++) {
+						bad += plane_at(&dst, x,
+								y)[c] !=
+						       average;
+					}
+				}
+			}
+		}
+	}
+	CHECK(bad == 0, "%d pixelated bytes differ from their cell average",
+	      bad);
+
+	free(src.data);
+	free(dst.data);
+}
+
+static void test_masks(void)
+{
+	const uint32_t w = 80, h = 40;
+	uint8_t *mask = malloc(w * h);
+
+	// Inner half of the frame, hard edged.
+	cpu_mask_box(mask, w, h, 0.25f, 0.25f, 0.25f, 0.25f, 0.0f, false);
+	CHECK(mask[0] == 0 && mask[(h - 1) * w + w - 1] == 0,
+	      "box mask blurs outside the box");
+	CHECK(mask[(h / 2) * w + w / 2] == 255 && mask[10 * w + 20] == 255,
+	      "box mask does not blur inside the box");
+	cpu_mask_box(mask, w, h, 0.25f, 0.25f, 0.25f, 0.25f, 0.0f, true);
+	CHECK(mask[0] == 255 && mask[(h / 2) * w + w / 2] == 0,
+	      "inverted box mask is not inverted");
+
+	// Feathering ramps up from the edge to the center.
+	cpu_mask_box(mask, w, h, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, false);
+	const uint8_t *row = mask + (h / 2) * w;
+	bool rising = true;
+	for (uint32_t x = 1; x <= w / 2; x++) {
+		rising = rising && row[x] >= row[x - 1];
+	}
+	CHECK(rising && row[0] < 32 && row[w / 2] > 223,
+	      "feathered box mask does not ramp to the center");
+
+	// Radius is a fraction of the shorter side, so 0.5 touches the
+	// top and bottom but not the left and right edges.
+	cpu_mask_circle(mask, w, h, 0.5f, 0.5f, 0.5f, 0.0f, false);
+	CHECK(mask[(h / 2) * w + w / 2] == 255 && mask[(h / 2) * w + 25] == 255,
+	      "circle mask does not blur inside the circle");
+	CHECK(mask[(h / 2) * w] == 0 && mask[0] == 0,
+	      "circle mask blurs outside the circle");
+	cpu_mask_circle(mask, w, h, 0.5f, 0.5f, 0.5f, 0.5f, false);
+	const uint8_t feathered = mask[(h / 2) * w + 25];
+	CHECK(mask[(h / 2) * w + w / 2] == 255 && feathered > 0 &&
+		      feathered < 255,
+	      "feathered circle mask does not fade out");
+
+	free(mask);
+}
+
+/*
+ *  Weight 0 restores the original, 255 keeps the blurred byte, and
+ *  weights in between land between the two. shift_x/shift_y map a
+ *  half size chroma plane onto the full size mask.
+ */
+static void test_blend_mask(thread_pool_t *pool)
+{
+	const uint32_t w = 24, h = 10;
+	uint8_t *mask = malloc(w * 2 * h * 2);
+	for (uint32_t y = 0; y < h * 2; y++) {
+		for (uint32_t x = 0; x < w * 2; x++) {
+			mask[y * w * 2 + x] = x < w * 2 / 3 ? 0
+					      : x < w * 4 / 3 ? 128
+							      : 255;
+		}
+	}
+
+	cpu_plane_t original = plane_create(w, h, 2);
+	cpu_plane_t dst = plane_create(w, h, 2);
+	memset(original.data, 40, (size_t)original.linesize * h);
+	memset(dst.data, 240, (size_t)dst.linesize * h);
+	cpu_blend_mask(pool, &original, &dst, mask, w * 2, h * 2, 1, 1);
+
+	int bad = 0;
+	for (uint32_t y = 0; y < h; y++) {
+		for (uint32_t x = 0; x < w; x++) {
+			const uint32_t mx = x * 2;
+			const int expected = mx < w * 2 / 3   ? 40
+					     : mx < w * 4 / 3 ? 140
+							      : 240;
+			for (uint32_t c = 0; c < 2; c++) {
+				bad += abs(plane_at(&dst, x, y)[c] - expected) >
+				       1;
+			}
+		}
+	}
+	CHECK(bad == 0, "%d blended chroma bytes off", bad);
+
+	free(mask);
+	free(original.data);
+	free(dst.data);
+}
+
+/*
+ *  Premultiplying and back keeps straight colors within rounding of
+ *  their alpha. Blurring premultiplied, a transparent white half must
+ *  not bleed into an opaque black one, in a packed plane and in a
+ *  color plane with alpha in a plane of its own.
+ */
+static void test_premultiply(thread_pool_t *pool)
+{
+	cpu_plane_t packed = plane_create(67, 29, 4);
+	cpu_plane_t copy = plane_create(67, 29, 4);
+	plane_fill_random(&packed, 7);
+	memcpy(copy.data, packed.data, (size_t)packed.linesize * 29);
+	cpu_premultiply(pool, &packed, &packed, 3, false);
+	cpu_premultiply(pool, &packed, &packed, 3, true);
+	int bad = 0;
+	for (int y = 0; y < 29; y++) {
+		for (int x = 0; x < 67; x++) {
+			const uint8_t *a = plane_at(&copy, x, y);
+			const uint8_t *b = plane_at(&packed, x, y);
+			const int limit = a[3] ? 128 / a[3] + 1 : 255;
+			for (int c = 0; c < 4; c++) {
+				bad += abs(a[c] - b[c]) > (c < 3 ? limit : 0);
+			}
+		}
+	}
+	CHECK(bad == 0, "%d bytes off after premultiplying and back", bad);
+	CHECK(!cpu_alpha_opaque(&packed, 3), "random alpha taken as opaque");
+
+	cpu_plane_t blurred = plane_create(67, 29, 4);
+	uint8_t *temp = malloc((size_t)67 * 4 * 29);
+	for (int y = 0; y < 29; y++) {
+		for (int x = 0; x < 67; x++) {
+			uint8_t *p = plane_at(&packed, x, y);
+			memset(p, x < 33 ? 0 : 255, 3);
+			p[3] = x < 33 ? 255 : 0;
+		}
+	}
+	cpu_premultiply(pool, &packed, &packed, 3, false);
+	cpu_blur_gaussian(pool, &packed, &blurred, temp, 4.0f, 4.0f);
+	cpu_premultiply(pool, &blurred, &blurred, 3, true);
+	int halo = 0;
+	for (int y = 0; y < 29; y++) {
+		for (int x = 0; x < 67; x++) {
+			const uint8_t *p = plane_at(&blurred, x, y);
+			halo += p[3] > 0 && (p[0] > 1 || p[1] > 1 || p[2] > 1);
+		}
+	}
+	CHECK(halo == 0, "%d packed pixels took the transparent color", halo);
+
+	cpu_plane_t color = plane_create(67, 29, 1);
+	cpu_plane_t alpha = plane_create(67, 29, 1);
+	cpu_plane_t color_out = plane_create(67, 29, 1);
+	cpu_plane_t alpha_out = plane_create(67, 29, 1);
+	for (int y = 0; y < 29; y++) {
+		for (int x = 0; x < 67; x++) {
+			*plane_at(&color, x, y) = x < 33 ? 0 : 255;
+			*plane_at(&alpha, x, y) = x < 33 ? 255 : 0;
+		}
+	}
+	cpu_premultiply(pool, &color, &alpha, 0, false);
+	cpu_blur_gaussian(pool, &color, &color_out, temp, 4.0f, 4.0f);
+	cpu_blur_gaussian(pool, &alpha, &alpha_out, temp, 4.0f, 4.0f);
+	cpu_premultiply(pool, &color_out, &alpha_out, 0, true);
+	halo = 0;
+	for (int y = 0; y < 29; y++) {
+		for (int x = 0; x < 67; x++) {
+			halo += *plane_at(&alpha_out, x, y) > 0 &&
+				*plane_at(&color_out, x, y) > 1;
+		}
+	}
+	CHECK(halo == 0, "%d planar pixels took the transparent color", halo);
+	CHECK(cpu_alpha_opaque(&alpha, 0) == false,
+	      "transparent alpha plane taken as opaque");
+
+	free(temp);
+	free(packed.data);
+	free(copy.data);
+	free(blurred.data);
+	free(color.data);
+	free(alpha.data);
+	free(color_out.data);
+	free(alpha_out.data);
+}
+
+int main(void)
+{
+	thread_pool_t *pool = thread_pool_create(3);
+
+	test_flat(pool);
+	test_box_reference(pool);
+	test_gaussian_reference(pool);
+	test_iir_matches_fir();
+	test_gaussian_anisotropic(pool);
+	test_threaded_matches_inline(pool);
+	test_pixelate(pool);
+	test_masks();
+	test_blend_mask(pool);
+	test_premultiply(pool);
+
+	thread_pool_destroy(pool);
+	return test_result("cpu-blur-test");
+}
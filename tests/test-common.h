@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Failed checks print where they failed and let the test carry on, so
+// one run lists every failure. main returns test_result().
+static int test_failures = 0;
+
+#define CHECK(cond, ...)                                              \
+	do {                                                          \
+		if (!(cond)) {                                        \
+			fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+			fprintf(stderr, __VA_ARGS__);                 \
+			fprintf(stderr, "\n");                        \
+			test_failures++;                              \
+		}                                                     \
+	} while (0)
+
+static inline int test_result(const char *name)
+{
+	if (test_failures) {
+		fprintf(stderr, "%s: %d check(s) failed\n", name,
+			test_failures);
+		return 1;
+	}
+	printf("%s: passed\n", name);
+	return 0;
+}
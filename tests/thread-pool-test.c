@@ -0,0 +1,108 @@
+#include "thread-pool.h"
+#include "test-common.h"
+
+#define VISIT_MAX 100003
+
+typedef struct visit_job {
+	volatile long visits[VISIT_MAX];
+	volatile long calls;
+	pthread_t caller;
+	volatile bool other_thread;
+} visit_job_t;
+
+static void visit(void *param, uint32_t start, uint32_t end)
+{
+	visit_job_t *job = param;
+	os_atomic_inc_long(&job->calls);
+	if (!pthread_equal(pthread_self(), job->caller)) {
+		os_atomic_store_bool(&job->other_thread, true);
+	}
+	for (uint32_t i = start; i < end; i++) {
+		os_atomic_inc_long(&job->visits[i]);
+	}
+}
+
+static void reset_job(visit_job_t *job)
+{
+	memset(job, 0, sizeof(visit_job_t));
+	job->caller = pthread_self();
+}
+
+// Every item of the range is handed to exactly one task call.
+static void test_visits_once(thread_pool_t *pool, visit_job_t *job)
+{
+	const uint32_t counts[] = {1, 2, 7, 64, 1000, VISIT_MAX};
+	const uint32_t chunks[] = {0, 1, 8, 5000};
+	for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+		for (size_t k = 0; k < sizeof(chunks) / sizeof(chunks[0]);
+		     k++) {
+			reset_job(job);
+			thread_pool_run(pool, counts[c], chunks[k], visit, job);
+			int bad = 0;
+			for (uint32_t i = 0; i < VISIT_MAX; i++) {
+				const long expected = i < counts[c] ? 1 : 0;
+				bad += job->visits[i] != expected;
+			}
+			CHECK(bad == 0,
+			      "count %u, min chunk %u: %d items visited "
+			      "other than once",
+			      counts[c], chunks[k], bad);
+		}
+	}
+}
+
+static void test_empty_range(thread_pool_t *pool, visit_job_t *job)
+{
+	reset_job(job);
+	thread_pool_run(pool, 0, 1, visit, job);
+	CHECK(job->calls == 0, "empty range called the task %ld times",
+	      job->calls);
+}
+
+// Without a pool, or with no workers, the caller runs the whole range
+// in a single call.
+static void test_inline(thread_pool_t *pool, visit_job_t *job)
+{
+	reset_job(job);
+	thread_pool_run(pool, 1000, 1, visit, job);
+	CHECK(job->calls == 1, "inline run took %ld calls", job->calls);
+	CHECK(!job->other_thread, "inline run left the calling thread");
+	CHECK(job->visits[0] == 1 && job->visits[999] == 1,
+	      "inline run missed the range ends");
+}
+
+// Jobs run back to back reuse the workers without losing items.
+static void test_repeated_runs(thread_pool_t *pool, visit_job_t *job)
+{
+	reset_job(job);
+	for (int run = 0; run < 2000; run++) {
+		thread_pool_run(pool, 97, 1, visit, job);
+	}
+	int bad = 0;
+	for (uint32_t i = 0; i < 97; i++) {
+		bad += job->visits[i] != 2000;
+	}
+	CHECK(bad == 0, "%d items missed or repeated over 2000 runs", bad);
+}
+
+int main(void)
+{
+	visit_job_t *job = malloc(sizeof(visit_job_t));
+
+	test_inline(NULL, job);
+	thread_pool_t *empty = thread_pool_create(0);
+	CHECK(empty != NULL, "creating a pool without workers failed");
+	test_inline(empty, job);
+	thread_pool_destroy(empty);
+
+	thread_pool_t *pool = thread_pool_create(4);
+	CHECK(pool && pool->thread_count == 4, "started %d of 4 workers",
+	      pool ? pool->thread_count : 0);
+	test_visits_once(pool, job);
+	test_empty_range(pool, job);
+	test_repeated_runs(pool, job);
+	thread_pool_destroy(pool);
+
+	free(job);
+	return test_result("thread-pool-test");
+}